@@ -0,0 +1,6 @@
+/* this file is autogenerated by CMake */
+/* DO NOT EDIT IT */
+
+#define REPO_VER "52dcd8"
+#define REPO_HASH "52dcd8"
+#define REPO_STATE "52dcd8"
@@ -361,6 +361,7 @@ extern char *default_routename;
 %token DNS_SEARCH_FMATCH
 %token DNS_NAPTR_IGNORE_RFC
 %token DNS_CACHE_INIT
+%token DNS_CACHE_HASH_SIZE
 %token DNS_USE_CACHE
 %token DNS_USE_FAILOVER
 %token DNS_CACHE_FLAGS
@@ -371,6 +372,7 @@ extern char *default_routename;
 %token DNS_CACHE_GC_INT
 %token DNS_CACHE_DEL_NONEXP
 %token DNS_CACHE_REC_PREF
+%token DNS_CACHE_PREFETCH
 
 /* ipv6 auto bind */
 %token AUTO_BIND_IPV6
@@ -512,7 +514,9 @@ extern char *default_routename;
 %token OPEN_FD_LIMIT
 %token SHM_MEM_SZ
 %token SHM_FORCE_ALLOC
+%token SHM_HUGE_PAGES
 %token MLOCK_PAGES
+%token MEM_PROFILE_RATE
 %token REAL_TIME
 %token RT_PRIO
 %token RT_POLICY
@@ -538,6 +542,8 @@ extern char *default_routename;
 %token WAIT_WORKER1_MODE
 %token WAIT_WORKER1_TIME
 %token WAIT_WORKER1_USLEEP
+%token CPU_AFFINITY_WORKERS
+%token CPU_AFFINITY_OTHERS
 %token CFG_DESCRIPTION
 %token SERVER_ID
 %token KEMI
@@ -992,6 +998,8 @@ assign_stm:
 	| DNS_NAPTR_IGNORE_RFC error { yyerror("boolean value expected"); }
 	| DNS_CACHE_INIT EQUAL NUMBER   { IF_DNS_CACHE(dns_cache_init=$3); }
 	| DNS_CACHE_INIT error { yyerror("boolean value expected"); }
+	| DNS_CACHE_HASH_SIZE EQUAL NUMBER   { IF_DNS_CACHE(dns_cache_hash_size=$3); }
+	| DNS_CACHE_HASH_SIZE error { yyerror("number expected"); }
 	| DNS_USE_CACHE EQUAL NUMBER   { IF_DNS_CACHE(default_core_cfg.use_dns_cache=$3); }
 	| DNS_USE_CACHE error { yyerror("boolean value expected"); }
 	| DNS_USE_FAILOVER EQUAL NUMBER   { IF_DNS_FAILOVER(default_core_cfg.use_dns_failover=$3);}
@@ -1012,6 +1020,8 @@ assign_stm:
 	| DNS_CACHE_DEL_NONEXP error { yyerror("boolean value expected"); }
 	| DNS_CACHE_REC_PREF EQUAL NUMBER   { IF_DNS_CACHE(default_core_cfg.dns_cache_rec_pref=$3); }
 	| DNS_CACHE_REC_PREF error { yyerror("boolean value expected"); }
+	| DNS_CACHE_PREFETCH EQUAL NUMBER   { IF_DNS_CACHE(default_core_cfg.dns_cache_prefetch=$3); }
+	| DNS_CACHE_PREFETCH error { yyerror("number expected"); }
 	| AUTO_BIND_IPV6 EQUAL NUMBER {IF_AUTO_BIND_IPV6(auto_bind_ipv6 = $3);}
 	| AUTO_BIND_IPV6 error { yyerror("boolean value expected"); }
 	| IPV6_HEX_STYLE EQUAL STRING {
@@ -1981,8 +1991,18 @@ assign_stm:
 			shm_force_alloc=$3;
 	}
 	| SHM_FORCE_ALLOC EQUAL error { yyerror("boolean value expected"); }
+	| SHM_HUGE_PAGES EQUAL NUMBER {
+		if (shm_initialized())
+			yyerror("shm_huge_pages must be before any modparam or the"
+					" route blocks");
+		else
+			shm_huge_pages=$3;
+	}
+	| SHM_HUGE_PAGES EQUAL error { yyerror("number expected"); }
 	| MLOCK_PAGES EQUAL NUMBER { mlock_pages=$3; }
 	| MLOCK_PAGES EQUAL error { yyerror("boolean value expected"); }
+	| MEM_PROFILE_RATE EQUAL NUMBER { mem_profile_rate=$3; }
+	| MEM_PROFILE_RATE EQUAL error { yyerror("number expected"); }
 	| REAL_TIME EQUAL NUMBER { real_time=$3; }
 	| REAL_TIME EQUAL error { yyerror("boolean value expected"); }
 	| RT_PRIO EQUAL NUMBER { rt_prio=$3; }
@@ -2083,6 +2103,10 @@ assign_stm:
 	| WAIT_WORKER1_TIME EQUAL error { yyerror("number expected"); }
 	| WAIT_WORKER1_USLEEP EQUAL NUMBER { ksr_wait_worker1_usleep=$3; }
 	| WAIT_WORKER1_USLEEP EQUAL error { yyerror("number expected"); }
+	| CPU_AFFINITY_WORKERS EQUAL STRING { ksr_cpu_affinity_workers=$3; }
+	| CPU_AFFINITY_WORKERS EQUAL error { yyerror("string expected"); }
+	| CPU_AFFINITY_OTHERS EQUAL STRING { ksr_cpu_affinity_others=$3; }
+	| CPU_AFFINITY_OTHERS EQUAL error { yyerror("string expected"); }
     | SERVER_ID EQUAL NUMBER { server_id=$3; }
 	| SERVER_ID EQUAL error  { yyerror("number expected"); }
     | RETURN_MODE EQUAL NUMBER { ksr_return_mode=$3; }
@@ -89,6 +89,7 @@ struct cfg_group_core
 	unsigned int dns_cache_max_mem;
 	int dns_cache_del_nonexp;
 	int dns_cache_rec_pref;
+	int dns_cache_prefetch;
 #endif
 #ifdef PKG_MALLOC
 	int mem_dump_pkg;
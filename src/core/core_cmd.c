@@ -32,6 +32,7 @@
 #include "ver.h"
 #include "mem/mem.h"
 #include "mem/shm_mem.h"
+#include "mem/memprof.h"
 #include "sr_module.h"
 #include "rpc_lookup.h"
 #include "dprint.h"
@@ -462,8 +463,8 @@ static void core_psx(rpc_t *rpc, void *c)
 
 	for(p = 0; p < *process_count; p++) {
 		rpc->add(c, "{", &handle);
-		rpc->struct_add(
-				handle, "dds", "IDX", p, "PID", pt[p].pid, "DSC", pt[p].desc);
+		rpc->struct_add(handle, "ddds", "IDX", p, "PID", pt[p].pid, "CPU",
+				pt[p].cpu, "DSC", pt[p].desc);
 	}
 }
 
@@ -588,14 +589,23 @@ static void core_shmmem(rpc_t *rpc, void *c)
 			(mi.free_size >> rs), "used", (mi.used_size >> rs), "real_used",
 			(mi.real_used >> rs), "max_used", (mi.max_used >> rs), "fragments",
 			mi.total_frags);
+	rpc->struct_add(handle, "d", "huge_pages", shm_core_huge_pages());
 }
 
+static const char *core_memprof_doc[] = {
+		"Returns the top allocating call sites recorded by the memory "
+		"profiler (mem_profile_rate), merged over all processes. It has an "
+		"optional parameter for the number of call sites to list.",
+		0 /* Method signature(s) */
+};
+
 static const char *core_shmmem_doc[] = {
 		"Returns shared memory info. It has an optional parameter that "
 		"specifies"
 		" the measuring unit: b - bytes (default), k or kb, m or mb, g or gb. "
 		"Note: when using something different from bytes, the value is "
-		"truncated.",
+		"truncated. The huge_pages field is the huge pages mode in effect "
+		"(0 - none, 1 - hugetlb, 2 - transparent).",
 		0 /* Method signature(s) */
 };
 
@@ -1075,6 +1085,7 @@ static rpc_export_t core_rpc_methods[] = {
 	{"core.arg", core_arg, core_arg_doc, RPC_RET_ARRAY},
 	{"core.kill", core_kill, core_kill_doc, 0},
 	{"core.shmmem", core_shmmem, core_shmmem_doc, 0},
+	{"core.memprof", memprof_rpc_top, core_memprof_doc, RPC_RET_ARRAY},
 #if defined(SF_MALLOC) || defined(LL_MALLOC)
 	{"core.sfmalloc", core_sfmalloc, core_sfmalloc_doc, 0},
 #endif
@@ -51,9 +51,10 @@
 #include "error.h"
 #include "rpc.h"
 #include "rand/fastrand.h"
-#ifdef USE_DNS_CACHE_STATS
 #include "pt.h"
-#endif
+#include "timer_proc.h"
+#include "sr_module.h"
+#include "cfg/cfg_struct.h"
 
 
 #ifndef MAX
@@ -64,7 +65,7 @@
 	255 /* maximum dns records number  received in a
 							   dns answer*/
 
-#define DNS_HASH_SIZE 1024			   /* must be <= 65535 */
+#define DNS_HASH_SIZE 1024			   /* default, must be <= 65535 */
 #define DEFAULT_DNS_TIMER_INTERVAL 120 /* 2 min. */
 #define DNS_HE_MAX_ADDR 10 /* maximum addresses returned in a hostent struct */
 #define MAX_CNAME_CHAIN 10
@@ -73,8 +74,15 @@
 	1000 /* one in a 1000*weight_sum chance for
 										selecting a 0-weight record */
 #define DNS_CACHE_RMDELAY 300
+/* minimum time between moves of an entry at the end of the last used list */
+#define DNS_LU_UPDATE_TICKS S_TO_TICKS(1)
+#define DNS_PREFETCH_MAX 32 /* max. records resolved again per timer run */
+#define DNS_PREFETCH_TIME_MAX \
+	MS_TO_TICKS(2000) /* max. time spent resolving per timer run */
 
 int dns_cache_init = 1; /* if 0, the DNS cache is not initialized at startup */
+/* number of hash table slots, rounded up to a power of 2 at init */
+unsigned int dns_cache_hash_size = DNS_HASH_SIZE;
 static gen_lock_t *dns_hash_lock = 0;
 static volatile unsigned int *dns_cache_mem_used = 0; /* current mem. use */
 unsigned int dns_timer_interval = DEFAULT_DNS_TIMER_INTERVAL; /* in s */
@@ -115,6 +123,7 @@ static struct dns_hash_head *dns_hash = 0;
 
 
 static struct timer_ln *dns_timer_h = 0;
+static int dns_prefetch_proc = 0; /* 1 if the prefetch process is forked */
 
 #ifdef DNS_WATCHDOG_SUPPORT
 static atomic_t *dns_servers_up = NULL;
@@ -206,6 +215,8 @@ void dns_hash_put_entry_shm_unsafe(
 
 inline static int dns_cache_clean(unsigned int no, int expired_only);
 inline static int dns_cache_free_mem(unsigned int target, int expired_only);
+static int dns_cache_prefetch(void);
+static void dns_prefetch_timer(unsigned int ticks, void *param);
 
 static ticks_t dns_timer(ticks_t ticks, struct timer_ln *tl, void *data)
 {
@@ -227,6 +238,36 @@ static ticks_t dns_timer(ticks_t ticks, struct timer_ln *tl, void *data)
 }
 
 
+/* runs the records prefetch from its own process, so that the blocking
+ * resolver calls do not delay the other slow timers */
+static void dns_prefetch_timer(unsigned int ticks, void *param)
+{
+#ifdef DNS_WATCHDOG_SUPPORT
+	if(atomic_get(dns_servers_up) == 0)
+		return;
+#endif
+	if(cfg_get(core, core_cfg, dns_cache_prefetch)) {
+		dns_cache_prefetch();
+	}
+}
+
+
+/* forks the dns prefetch process from the main process, if enabled
+ * at startup */
+int dns_cache_prefetch_child_init(int rank)
+{
+	if(rank != PROC_MAIN || dns_prefetch_proc == 0)
+		return 0;
+	if(fork_basic_timer(PROC_TIMER, "dns prefetch timer", 1,
+			   dns_prefetch_timer, NULL, dns_timer_interval)
+			< 0) {
+		LM_ERR("failed to start the dns prefetch timer process\n");
+		return -1;
+	}
+	return 0;
+}
+
+
 void destroy_dns_cache()
 {
 	if(dns_timer_h) {
@@ -372,13 +413,21 @@ int init_dns_cache()
 	}
 	clist_init(dns_last_used_lst, next, prev);
 
-	dns_hash = shm_malloc(sizeof(struct dns_hash_head) * DNS_HASH_SIZE);
+	if(dns_cache_hash_size == 0 || dns_cache_hash_size > 32768) {
+		LM_WARN("invalid dns cache hash size %u - using %u\n",
+				dns_cache_hash_size, DNS_HASH_SIZE);
+		dns_cache_hash_size = DNS_HASH_SIZE;
+	}
+	for(r = 1; r < dns_cache_hash_size; r <<= 1)
+		;
+	dns_cache_hash_size = r;
+	dns_hash = shm_malloc(sizeof(struct dns_hash_head) * dns_cache_hash_size);
 	if(dns_hash == 0) {
 		SHM_MEM_ERROR;
 		ret = E_OUT_OF_MEM;
 		goto error;
 	}
-	for(r = 0; r < DNS_HASH_SIZE; r++)
+	for(r = 0; r < dns_cache_hash_size; r++)
 		clist_init(&dns_hash[r], next, prev);
 
 	dns_hash_lock = lock_alloc();
@@ -424,6 +473,12 @@ int init_dns_cache()
 			dns_timer_h = 0;
 			goto error;
 		}
+		if(default_core_cfg.dns_cache_prefetch) {
+			/* advertise the prefetch process to core and cfg framework */
+			register_procs(1);
+			cfg_register_child(1);
+			dns_prefetch_proc = 1;
+		}
 	}
 
 	return 0;
@@ -459,7 +514,7 @@ int init_dns_cache_stats(int iproc_num)
  * returns the hash value
  */
 #define dns_hash_no(s, len, type) \
-	(get_hash1_case_raw((s), (len)) % DNS_HASH_SIZE)
+	(get_hash1_case_raw((s), (len)) & (dns_cache_hash_size - 1))
 
 
 #include <stdlib.h> /* abort() */
@@ -578,12 +633,16 @@ again:
 			}
 		} else if((e->type == type) && (e->name_len == name->len)
 				  && (strncasecmp(e->name, name->s, e->name_len) == 0)) {
-			e->last_used = now;
-			/* add it at the end */
-			debug_lu_lst("_dns_hash_find: pre rm:", &e->last_used_lst);
-			clist_rm(&e->last_used_lst, next, prev);
-			clist_append(dns_last_used_lst, &e->last_used_lst, next, prev);
-			debug_lu_lst("_dns_hash_find: post append:", &e->last_used_lst);
+			/* add it at the end, if not moved there recently (avoid
+			 * relinking the list for each lookup of a hot entry) */
+			if((s_ticks_t)(now - e->last_used) >= DNS_LU_UPDATE_TICKS) {
+				e->last_used = now;
+				debug_lu_lst("_dns_hash_find: pre rm:", &e->last_used_lst);
+				clist_rm(&e->last_used_lst, next, prev);
+				clist_append(dns_last_used_lst, &e->last_used_lst, next, prev);
+				debug_lu_lst(
+						"_dns_hash_find: post append:", &e->last_used_lst);
+			}
 			return e;
 		} else if((e->type == T_CNAME)
 				  && !((e->rr_lst == 0) || (e->ent_flags & DNS_FLAG_BAD_NAME))
@@ -591,13 +650,16 @@ again:
 				  && (strncasecmp(e->name, name->s, e->name_len) == 0)) {
 			/*if CNAME matches and CNAME is entry is not a neg. cache entry
 			  (could be produced by a specific CNAME lookup)*/
-			e->last_used = now;
-			/* add it at the end */
-			debug_lu_lst("_dns_hash_find: cname: pre rm:", &e->last_used_lst);
-			clist_rm(&e->last_used_lst, next, prev);
-			clist_append(dns_last_used_lst, &e->last_used_lst, next, prev);
-			debug_lu_lst(
-					"_dns_hash_find: cname: post append:", &e->last_used_lst);
+			/* add it at the end, if not moved there recently */
+			if((s_ticks_t)(now - e->last_used) >= DNS_LU_UPDATE_TICKS) {
+				e->last_used = now;
+				debug_lu_lst(
+						"_dns_hash_find: cname: pre rm:", &e->last_used_lst);
+				clist_rm(&e->last_used_lst, next, prev);
+				clist_append(dns_last_used_lst, &e->last_used_lst, next, prev);
+				debug_lu_lst("_dns_hash_find: cname: post append:",
+						&e->last_used_lst);
+			}
 			ret = e; /* if this is an unfinished cname chain, we try to
 					  return the last cname */
 			/* this is a cname => retry using its value */
@@ -720,6 +782,84 @@ inline static int dns_cache_free_mem(unsigned int target, int expired_only)
 }
 
 
+inline static struct dns_hash_entry *dns_cache_do_request(
+		str *name, int type);
+
+/* resolves again the records used since the previous timer run that
+ * are about to expire, so that they are not resolved from a worker
+ * process on the next lookup. The new records are added to the cache
+ * next to the old ones, which are used until they expire (or replaced
+ * right away, depending on dns_cache_rec_pref).
+ * Each run is limited to DNS_PREFETCH_MAX records and DNS_PREFETCH_TIME_MAX,
+ * the records not requested in time are left for the next run.
+ * returns the number of records requested
+ * This should be called from the dns prefetch timer process */
+static int dns_cache_prefetch(void)
+{
+	struct dns_hash_entry *recs[DNS_PREFETCH_MAX];
+	struct dns_hash_entry *e;
+	struct dns_lu_lst *l;
+	ticks_t now;
+	ticks_t window;
+	str name;
+	int n;
+	int i;
+	int k;
+
+	n = 0;
+	now = get_ticks_raw();
+	window = S_TO_TICKS(cfg_get(core, core_cfg, dns_cache_prefetch));
+	LOCK_DNS_HASH();
+	/* walk from the most recently used end */
+	for(l = dns_last_used_lst->prev;
+			l != dns_last_used_lst && n < DNS_PREFETCH_MAX; l = l->prev) {
+		e = (struct dns_hash_entry *)(((char *)l)
+									  - (char *)&((struct dns_hash_entry *)(0))
+												->last_used_lst);
+		if((s_ticks_t)(now - e->last_used - S_TO_TICKS(dns_timer_interval))
+				> 0)
+			break; /* not used since the previous run */
+		if((e->ent_flags
+				   & (DNS_FLAG_PERMANENT | DNS_FLAG_BAD_NAME
+						   | DNS_FLAG_PREFETCHED))
+				|| (e->type == T_CNAME) || ((s_ticks_t)(now - e->expire) >= 0)
+				|| ((s_ticks_t)(e->expire - now - window) > 0))
+			continue;
+		e->ent_flags |= DNS_FLAG_PREFETCHED;
+		/* keep a reference, the name is used outside the lock */
+		atomic_inc(&e->refcnt);
+		recs[n] = e;
+		n++;
+	}
+	UNLOCK_DNS_HASH();
+
+	k = 0;
+	for(i = 0; i < n; i++) {
+		if((s_ticks_t)(get_ticks_raw() - now - DNS_PREFETCH_TIME_MAX) > 0)
+			break;
+		name.s = recs[i]->name;
+		name.len = recs[i]->name_len;
+		LM_DBG("prefetching %.*s (%d)\n", name.len, name.s, recs[i]->type);
+		e = dns_cache_do_request(&name, recs[i]->type);
+		if(e)
+			dns_hash_put(e);
+		dns_hash_put(recs[i]);
+		k++;
+	}
+	if(i < n) {
+		LM_DBG("prefetch time exceeded - %d records left for the next run\n",
+				n - i);
+		LOCK_DNS_HASH();
+		for(; i < n; i++)
+			recs[i]->ent_flags &= ~DNS_FLAG_PREFETCHED;
+		UNLOCK_DNS_HASH();
+		for(i = k; i < n; i++)
+			dns_hash_put(recs[i]);
+	}
+	return k;
+}
+
+
 /* locking  version (the dns hash must _not_be locked externally)
  * returns 0 when not found, the searched entry on success (with CNAMEs
  *  followed) or the last CNAME entry from an unfinished CNAME chain,
@@ -3638,7 +3778,7 @@ void dns_cache_debug(rpc_t *rpc, void *ctx)
 	}
 	now = get_ticks_raw();
 	LOCK_DNS_HASH();
-	for(h = 0; h < DNS_HASH_SIZE; h++) {
+	for(h = 0; h < dns_cache_hash_size; h++) {
 		clist_foreach(&dns_hash[h], e, next)
 		{
 			rpc->add(ctx, "sdddddd", e->name, e->type, e->total_size,
@@ -3746,7 +3886,7 @@ void dns_cache_debug_all(rpc_t *rpc, void *ctx)
 	}
 	now = get_ticks_raw();
 	LOCK_DNS_HASH();
-	for(h = 0; h < DNS_HASH_SIZE; h++) {
+	for(h = 0; h < dns_cache_hash_size; h++) {
 		clist_foreach(&dns_hash[h], e, next)
 		{
 			for(i = 0, rr = e->rr_lst; rr; i++, rr = rr->next) {
@@ -4095,7 +4235,7 @@ void dns_cache_view(rpc_t *rpc, void *ctx)
 	}
 	now = get_ticks_raw();
 	LOCK_DNS_HASH();
-	for(h = 0; h < DNS_HASH_SIZE; h++) {
+	for(h = 0; h < dns_cache_hash_size; h++) {
 		clist_foreach(&dns_hash[h], e, next)
 		{
 			if(((e->ent_flags & DNS_FLAG_PERMANENT) == 0)
@@ -4124,7 +4264,7 @@ void dns_cache_flush(int del_permanent)
 
 	LM_DBG("removing elements from the cache\n");
 	LOCK_DNS_HASH();
-	for(h = 0; h < DNS_HASH_SIZE; h++) {
+	for(h = 0; h < dns_cache_hash_size; h++) {
 		clist_foreach_safe(&dns_hash[h], e, tmp, next)
 		{
 			if(del_permanent || ((e->ent_flags & DNS_FLAG_PERMANENT) == 0))
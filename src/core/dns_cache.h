@@ -102,6 +102,9 @@ const char *dns_strerror(int err);
 	2 /**< permanent record, never times out,
 					never deleted, never overwritten
 					unless explicitely requested */
+#define DNS_FLAG_PREFETCHED \
+	4 /**< a newer record was already requested
+					by the cache timer */
 /*@} */
 
 /** @name dns requests flags */
@@ -188,6 +191,7 @@ int use_dns_failover_fixup(void *handle, str *gname, str *name, void **val);
 int use_dns_cache_fixup(void *handle, str *gname, str *name, void **val);
 int dns_cache_max_mem_fixup(void *handle, str *gname, str *name, void **val);
 int init_dns_cache(void);
+int dns_cache_prefetch_child_init(int rank);
 #ifdef USE_DNS_CACHE_STATS
 int init_dns_cache_stats(int iproc_num);
 #define DNS_CACHE_ALL_STATS "dc_all_stats"
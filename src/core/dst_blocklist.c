@@ -44,6 +44,7 @@
 #include "error.h"
 #include "rpc.h"
 #include "compiler_opt.h"
+#include "atomic_ops.h"
 #include "resolve.h" /* for str2ip */
 #ifdef USE_DST_BLOCKLIST_STATS
 #include "pt.h"
@@ -123,7 +124,8 @@ int dst_blocklist_init =
 		1; /* if 0, the dst blocklist is not initialized at startup */
 static struct timer_ln *blst_timer_h = 0;
 
-static volatile unsigned int *blst_mem_used = 0;
+/* memory used by the entries, 0 when the blocklist is empty */
+static atomic_t *blst_mem_used = 0;
 unsigned int blst_timer_interval = DEFAULT_BLST_TIMER_INTERVAL;
 struct dst_blst_lst_head *dst_blst_hash = 0;
 
@@ -432,7 +434,7 @@ int init_dst_blocklist()
 		ret = E_OUT_OF_MEM;
 		goto error;
 	}
-	*blst_mem_used = 0;
+	atomic_set(blst_mem_used, 0);
 	dst_blst_hash =
 			shm_malloc(sizeof(struct dst_blst_lst_head) * DST_BLST_HASH_SIZE);
 	if(dst_blst_hash == 0) {
@@ -555,7 +557,7 @@ inline static struct dst_blst_entry *_dst_blocklist_lst_find(
 		if((s_ticks_t)(now - (*crt)->expire) >= 0) {
 			*crt = (*crt)->next;
 			tmp = crt;
-			*blst_mem_used -= DST_BLST_ENTRY_SIZE(*e);
+			atomic_add(blst_mem_used, -(int)DST_BLST_ENTRY_SIZE(*e));
 			BLST_HASH_STATS_DEC(hash);
 			blst_destroy_entry(e);
 		} else if((e->port == port) && ((e->flags & BLST_IS_IPV6) == type)
@@ -592,7 +594,7 @@ inline static int _dst_blocklist_del(unsigned short hash, struct ip_addr *ip,
 		if((s_ticks_t)(now - (*crt)->expire) >= 0) {
 			*crt = (*crt)->next;
 			tmp = crt;
-			*blst_mem_used -= DST_BLST_ENTRY_SIZE(*e);
+			atomic_add(blst_mem_used, -(int)DST_BLST_ENTRY_SIZE(*e));
 			BLST_HASH_STATS_DEC(hash);
 			blst_destroy_entry(e);
 		} else if((e->port == port) && ((e->flags & BLST_IS_IPV6) == type)
@@ -601,7 +603,7 @@ inline static int _dst_blocklist_del(unsigned short hash, struct ip_addr *ip,
 				  && (memcmp(ip->u.addr, e->ip, ip->len) == 0)) {
 			*crt = (*crt)->next;
 			tmp = crt;
-			*blst_mem_used -= DST_BLST_ENTRY_SIZE(*e);
+			atomic_add(blst_mem_used, -(int)DST_BLST_ENTRY_SIZE(*e));
 			BLST_HASH_STATS_DEC(hash);
 			blst_destroy_entry(e);
 			return 1;
@@ -648,11 +650,11 @@ inline static int dst_blocklist_clean_expired(
 				if((s_ticks_t)(now + delta - (*crt)->expire) >= 0) {
 					*crt = (*crt)->next;
 					tmp = crt;
-					*blst_mem_used -= DST_BLST_ENTRY_SIZE(*e);
+					atomic_add(blst_mem_used, -(int)DST_BLST_ENTRY_SIZE(*e));
 					blst_destroy_entry(e);
 					BLST_HASH_STATS_DEC(i);
 					no++;
-					if(*blst_mem_used <= target) {
+					if((unsigned int)atomic_get(blst_mem_used) <= target) {
 						UNLOCK_BLST(i);
 						goto skip;
 					}
@@ -680,7 +682,8 @@ skip:
 /* timer */
 static ticks_t blst_timer(ticks_t ticks, struct timer_ln *tl, void *data)
 {
-	dst_blocklist_clean_expired(0, 0, 2); /*spend max. 2 ticks*/
+	if(atomic_get(blst_mem_used) != 0)
+		dst_blocklist_clean_expired(0, 0, 2); /*spend max. 2 ticks*/
 	return (ticks_t)(-1);
 }
 
@@ -716,7 +719,7 @@ inline static int dst_blocklist_add_ip(unsigned char err_flags,
 		e->flags |= err_flags;
 		e->expire = now + timeout; /* update the timeout */
 	} else {
-		if(unlikely((*blst_mem_used + size)
+		if(unlikely(((unsigned int)atomic_get(blst_mem_used) + size)
 					>= cfg_get(core, core_cfg, blst_max_mem))) {
 #ifdef USE_DST_BLOCKLIST_STATS
 			dst_blocklist_stats[process_no].bkl_lru_cnt++;
@@ -725,8 +728,9 @@ inline static int dst_blocklist_add_ip(unsigned char err_flags,
 			/* first try to free some memory  (~ 12%), but don't
 				 * spend more than 250 ms*/
 			dst_blocklist_clean_expired(
-					*blst_mem_used / 16 * 14, 0, MS_TO_TICKS(250));
-			if(unlikely(*blst_mem_used + size
+					(unsigned int)atomic_get(blst_mem_used) / 16 * 14, 0,
+					MS_TO_TICKS(250));
+			if(unlikely((unsigned int)atomic_get(blst_mem_used) + size
 						>= cfg_get(core, core_cfg, blst_max_mem))) {
 				ret = -1;
 				goto error;
@@ -740,7 +744,7 @@ inline static int dst_blocklist_add_ip(unsigned char err_flags,
 			ret = E_OUT_OF_MEM;
 			goto error;
 		}
-		*blst_mem_used += size;
+		atomic_add(blst_mem_used, size);
 		e->flags = err_flags;
 		e->proto = proto;
 		e->port = port;
@@ -765,6 +769,9 @@ inline static int dst_is_blocklisted_ip(
 	ticks_t now;
 	int ret;
 
+	/* fast path: empty blocklist, no need to touch the hash table */
+	if(likely(atomic_get(blst_mem_used) == 0))
+		return 0;
 	ret = 0;
 	now = get_ticks_raw();
 	hash = dst_blst_hash_no(proto, ip, port);
@@ -888,7 +895,8 @@ void dst_blst_mem_info(rpc_t *rpc, void *ctx)
 		rpc->fault(ctx, 500, "dst blocklist support disabled");
 		return;
 	}
-	rpc->add(ctx, "dd", *blst_mem_used, cfg_get(core, core_cfg, blst_max_mem));
+	rpc->add(ctx, "dd", (unsigned int)atomic_get(blst_mem_used),
+			cfg_get(core, core_cfg, blst_max_mem));
 }
 
 
@@ -1069,7 +1077,7 @@ void dst_blst_flush(void)
 			if(!(e->flags & BLST_PERMANENT)) {
 				*crt = (*crt)->next;
 				tmp = crt;
-				*blst_mem_used -= DST_BLST_ENTRY_SIZE(*e);
+				atomic_add(blst_mem_used, -(int)DST_BLST_ENTRY_SIZE(*e));
 				blst_destroy_entry(e);
 				BLST_HASH_STATS_DEC(h);
 			}
@@ -206,6 +206,8 @@ extern int open_files_limit;
 
 /* memory lock/pre-fault */
 extern int shm_force_alloc;
+extern int shm_huge_pages;
+extern int mem_profile_rate;
 extern int mlock_pages;
 
 /* execute onsend_route for replies */
@@ -241,6 +243,9 @@ extern int ksr_wait_worker1_time;
 extern int ksr_wait_worker1_usleep;
 extern int *ksr_wait_worker1_done;
 
+extern char *ksr_cpu_affinity_workers;
+extern char *ksr_cpu_affinity_others;
+
 extern char *_sr_uri_host_extra_chars;
 extern unsigned char *_ksr_hname_extra_chars;
 
@@ -264,6 +269,7 @@ extern int ksr_udp_accept_proxy;
 #ifdef USE_DNS_CACHE
 extern int
 		dns_cache_init; /* if 0, the DNS cache is not initialized at startup */
+extern unsigned int dns_cache_hash_size; /* number of hash table slots */
 extern unsigned int dns_timer_interval; /* gc timer interval in s */
 extern int dns_flags; /* default flags used for the  dns_*resolvehost
                     (compatibility wrappers) */
@@ -0,0 +1,452 @@
+/*
+ * Copyright (C) 2026 kamailio.org
+ *
+ * This file is part of Kamailio, a free SIP server.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * \file
+ * \brief Sampling allocation profiler for pkg and shm memory
+ *
+ * When enabled, the allocation functions of the pkg and shm memory
+ * managers are wrapped and every mem_profile_rate-th allocation is
+ * accounted to its call site, in a per process table kept in shm, so
+ * it can be inspected over RPC. For pkg, the sampled chunks are also
+ * tracked until freed, to report the bytes still in use per call site.
+ * \ingroup mem
+ */
+
+#include <string.h>
+#include <time.h>
+
+#include "../dprint.h"
+#include "../pt.h"
+#include "pkg.h"
+#include "shm.h"
+#include "memprof.h"
+
+int mem_profile_rate = 0;
+
+#ifdef DBG_SR_MEMORY
+
+#define MEMPROF_SITES 256  /* call sites per process (power of 2) */
+#define MEMPROF_LIVE 4096  /* tracked pkg chunks per process (power of 2) */
+#define MEMPROF_PROBES 8   /* max slots checked on hash collisions */
+#define MEMPROF_AGG 1024   /* call sites merged for the rpc (power of 2) */
+#define MEMPROF_TOP_DEF 20 /* default number of sites listed over rpc */
+#define MEMPROF_TOP_MAX 100
+
+#define MEMPROF_PKG 0
+#define MEMPROF_SHM 1
+
+#define MEMPROF_DELETED ((void *)1)
+
+typedef struct memprof_site
+{
+	const char *file;
+	const char *func;
+	const char *mname;
+	unsigned int line;
+	unsigned int pool;
+	unsigned long allocs; /* sampled allocations */
+	unsigned long bytes;  /* sampled allocated bytes */
+	unsigned long live;	  /* sampled bytes not freed yet (pkg only) */
+	int procs;			  /* processes with this site (rpc only) */
+} memprof_site_t;
+
+typedef struct memprof_chunk
+{
+	void *p;
+	unsigned long size;
+	memprof_site_t *site;
+	int proc; /* process that sampled it - chunks are inherited on fork */
+} memprof_chunk_t;
+
+/* per process call site tables, in shm */
+static memprof_site_t *_memprof_sites = NULL;
+static int _memprof_procs = 0;
+static time_t *_memprof_start = NULL;
+
+/* sampled pkg chunks of this process */
+static memprof_chunk_t _memprof_chunks[MEMPROF_LIVE];
+/* allocations left until the next sample */
+static int _memprof_skip = 0;
+
+/* the wrapped memory manager functions */
+static sr_pkg_api_t _memprof_pkg;
+static sr_shm_api_t _memprof_shm;
+
+static inline unsigned int memprof_site_hash(
+		const char *file, unsigned int line, unsigned int pool)
+{
+	return (unsigned int)(((unsigned long)file >> 3) ^ (line * 2654435761U)
+						  ^ pool);
+}
+
+static inline unsigned int memprof_chunk_hash(void *p)
+{
+	return (unsigned int)(((unsigned long)p >> 4) * 2654435761U);
+}
+
+/**
+ * find or add the call site in a table
+ */
+static memprof_site_t *memprof_site_get(memprof_site_t *tbl, unsigned int size,
+		const char *file, const char *func, unsigned int line,
+		const char *mname, unsigned int pool)
+{
+	memprof_site_t *s;
+	unsigned int h;
+	unsigned int i;
+
+	h = memprof_site_hash(file, line, pool);
+	for(i = 0; i < MEMPROF_PROBES; i++) {
+		s = &tbl[(h + i) & (size - 1)];
+		if(s->file == file && s->line == line && s->pool == pool)
+			return s;
+		if(s->file == NULL) {
+			s->func = func;
+			s->mname = mname;
+			s->line = line;
+			s->pool = pool;
+			s->file = file;
+			return s;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * true if the current allocation has to be sampled
+ */
+static inline int memprof_sample(void)
+{
+	if(likely(--_memprof_skip > 0))
+		return 0;
+	_memprof_skip = mem_profile_rate;
+	return (process_no < _memprof_procs);
+}
+
+static void memprof_record(void *p, size_t size, const char *file,
+		const char *func, unsigned int line, const char *mname,
+		unsigned int pool)
+{
+	memprof_site_t *s;
+	memprof_chunk_t *c;
+	unsigned int h;
+	unsigned int i;
+
+	s = memprof_site_get(_memprof_sites + process_no * MEMPROF_SITES,
+			MEMPROF_SITES, file, func, line, mname, pool);
+	if(s == NULL)
+		return;
+	s->allocs++;
+	s->bytes += size;
+	if(pool != MEMPROF_PKG)
+		return;
+	h = memprof_chunk_hash(p);
+	for(i = 0; i < MEMPROF_PROBES; i++) {
+		c = &_memprof_chunks[(h + i) & (MEMPROF_LIVE - 1)];
+		if(c->p == NULL || c->p == MEMPROF_DELETED) {
+			c->p = p;
+			c->size = size;
+			c->site = s;
+			c->proc = process_no;
+			s->live += size;
+			return;
+		}
+	}
+	/* no room to track it - not counted as live */
+}
+
+#ifdef PKG_MALLOC
+static void memprof_forget(void *p)
+{
+	memprof_chunk_t *c;
+	unsigned int h;
+	unsigned int i;
+
+	h = memprof_chunk_hash(p);
+	for(i = 0; i < MEMPROF_PROBES; i++) {
+		c = &_memprof_chunks[(h + i) & (MEMPROF_LIVE - 1)];
+		if(c->p == p) {
+			if(c->proc == process_no)
+				c->site->live -= c->size;
+			c->p = MEMPROF_DELETED;
+			return;
+		}
+		if(c->p == NULL)
+			return;
+	}
+}
+
+static void *memprof_pkg_malloc(void *mbp, size_t size, const char *file,
+		const char *func, unsigned int line, const char *mname)
+{
+	void *p;
+
+	p = _memprof_pkg.xmalloc(mbp, size, file, func, line, mname);
+	if(unlikely(memprof_sample()) && p)
+		memprof_record(p, size, file, func, line, mname, MEMPROF_PKG);
+	return p;
+}
+
+static void *memprof_pkg_mallocxz(void *mbp, size_t size, const char *file,
+		const char *func, unsigned int line, const char *mname)
+{
+	void *p;
+
+	p = _memprof_pkg.xmallocxz(mbp, size, file, func, line, mname);
+	if(unlikely(memprof_sample()) && p)
+		memprof_record(p, size, file, func, line, mname, MEMPROF_PKG);
+	return p;
+}
+
+static void *memprof_pkg_realloc(void *mbp, void *p, size_t size,
+		const char *file, const char *func, unsigned int line,
+		const char *mname)
+{
+	void *r;
+
+	r = _memprof_pkg.xrealloc(mbp, p, size, file, func, line, mname);
+	if(p && (r || size == 0))
+		memprof_forget(p);
+	if(unlikely(memprof_sample()) && r)
+		memprof_record(r, size, file, func, line, mname, MEMPROF_PKG);
+	return r;
+}
+
+static void *memprof_pkg_reallocxf(void *mbp, void *p, size_t size,
+		const char *file, const char *func, unsigned int line,
+		const char *mname)
+{
+	void *r;
+
+	r = _memprof_pkg.xreallocxf(mbp, p, size, file, func, line, mname);
+	if(p)
+		memprof_forget(p);
+	if(unlikely(memprof_sample()) && r)
+		memprof_record(r, size, file, func, line, mname, MEMPROF_PKG);
+	return r;
+}
+
+static void memprof_pkg_free(void *mbp, void *p, const char *file,
+		const char *func, unsigned int line, const char *mname)
+{
+	if(p)
+		memprof_forget(p);
+	_memprof_pkg.xfree(mbp, p, file, func, line, mname);
+}
+
+#endif /* PKG_MALLOC */
+
+static void *memprof_shm_malloc(void *mbp, size_t size, const char *file,
+		const char *func, unsigned int line, const char *mname)
+{
+	void *p;
+
+	p = _memprof_shm.xmalloc(mbp, size, file, func, line, mname);
+	if(unlikely(memprof_sample()) && p)
+		memprof_record(p, size, file, func, line, mname, MEMPROF_SHM);
+	return p;
+}
+
+static void *memprof_shm_mallocxz(void *mbp, size_t size, const char *file,
+		const char *func, unsigned int line, const char *mname)
+{
+	void *p;
+
+	p = _memprof_shm.xmallocxz(mbp, size, file, func, line, mname);
+	if(unlikely(memprof_sample()) && p)
+		memprof_record(p, size, file, func, line, mname, MEMPROF_SHM);
+	return p;
+}
+
+static void *memprof_shm_malloc_unsafe(void *mbp, size_t size,
+		const char *file, const char *func, unsigned int line,
+		const char *mname)
+{
+	void *p;
+
+	p = _memprof_shm.xmalloc_unsafe(mbp, size, file, func, line, mname);
+	if(unlikely(memprof_sample()) && p)
+		memprof_record(p, size, file, func, line, mname, MEMPROF_SHM);
+	return p;
+}
+
+static void *memprof_shm_realloc(void *mbp, void *p, size_t size,
+		const char *file, const char *func, unsigned int line,
+		const char *mname)
+{
+	void *r;
+
+	r = _memprof_shm.xrealloc(mbp, p, size, file, func, line, mname);
+	if(unlikely(memprof_sample()) && r)
+		memprof_record(r, size, file, func, line, mname, MEMPROF_SHM);
+	return r;
+}
+
+static void *memprof_shm_reallocxf(void *mbp, void *p, size_t size,
+		const char *file, const char *func, unsigned int line,
+		const char *mname)
+{
+	void *r;
+
+	r = _memprof_shm.xreallocxf(mbp, p, size, file, func, line, mname);
+	if(unlikely(memprof_sample()) && r)
+		memprof_record(r, size, file, func, line, mname, MEMPROF_SHM);
+	return r;
+}
+
+/**
+ * init the profiler and wrap the memory managers - it has to be done in
+ * main process, before forking
+ */
+int memprof_init(int procs)
+{
+	if(mem_profile_rate <= 0)
+		return 0;
+	if(_memprof_sites != NULL)
+		return 0;
+
+	_memprof_sites = (memprof_site_t *)shm_mallocxz(
+			procs * MEMPROF_SITES * sizeof(memprof_site_t) + sizeof(time_t));
+	if(_memprof_sites == NULL) {
+		SHM_MEM_ERROR;
+		return -1;
+	}
+	_memprof_start = (time_t *)(_memprof_sites + procs * MEMPROF_SITES);
+	*_memprof_start = time(NULL);
+	_memprof_procs = procs;
+	_memprof_skip = mem_profile_rate;
+
+#ifdef PKG_MALLOC
+	_memprof_pkg = _pkg_root;
+	_pkg_root.xmalloc = memprof_pkg_malloc;
+	_pkg_root.xmallocxz = memprof_pkg_mallocxz;
+	_pkg_root.xrealloc = memprof_pkg_realloc;
+	_pkg_root.xreallocxf = memprof_pkg_reallocxf;
+	_pkg_root.xfree = memprof_pkg_free;
+#endif
+
+	_memprof_shm = _shm_root;
+	_shm_root.xmalloc = memprof_shm_malloc;
+	_shm_root.xmallocxz = memprof_shm_mallocxz;
+	_shm_root.xmalloc_unsafe = memprof_shm_malloc_unsafe;
+	_shm_root.xrealloc = memprof_shm_realloc;
+	_shm_root.xreallocxf = memprof_shm_reallocxf;
+
+	LM_INFO("memory allocation profiler enabled - sampling rate: 1/%d\n",
+			mem_profile_rate);
+	return 0;
+}
+
+/**
+ * rpc command listing the top allocating call sites, merged over all
+ * processes and ordered by allocated bytes
+ */
+void memprof_rpc_top(rpc_t *rpc, void *ctx)
+{
+	memprof_site_t *agg;
+	memprof_site_t *s;
+	memprof_site_t *a;
+	memprof_site_t *best;
+	int top;
+	int p;
+	int i;
+	int n;
+	int lost;
+	long secs;
+	void *th;
+
+	if(_memprof_sites == NULL) {
+		rpc->fault(ctx, 500, "Memory profiler not enabled");
+		return;
+	}
+	if(rpc->scan(ctx, "*d", &top) < 1)
+		top = MEMPROF_TOP_DEF;
+	if(top <= 0 || top > MEMPROF_TOP_MAX)
+		top = MEMPROF_TOP_MAX;
+
+	agg = (memprof_site_t *)pkg_mallocxz(MEMPROF_AGG * sizeof(memprof_site_t));
+	if(agg == NULL) {
+		PKG_MEM_ERROR;
+		rpc->fault(ctx, 500, "No more memory");
+		return;
+	}
+	lost = 0;
+	for(p = 0; p < _memprof_procs; p++) {
+		for(i = 0; i < MEMPROF_SITES; i++) {
+			s = &_memprof_sites[p * MEMPROF_SITES + i];
+			if(s->file == NULL)
+				continue;
+			a = memprof_site_get(agg, MEMPROF_AGG, s->file, s->func, s->line,
+					s->mname, s->pool);
+			if(a == NULL) {
+				lost++;
+				continue;
+			}
+			a->allocs += s->allocs;
+			a->bytes += s->bytes;
+			a->live += s->live;
+			a->procs++;
+		}
+	}
+	if(lost)
+		LM_DBG("%d call site entries not merged\n", lost);
+
+	secs = (long)(time(NULL) - *_memprof_start);
+	if(secs <= 0)
+		secs = 1;
+	for(n = 0; n < top; n++) {
+		best = NULL;
+		for(i = 0; i < MEMPROF_AGG; i++) {
+			if(agg[i].file != NULL && agg[i].allocs
+					&& (best == NULL || agg[i].bytes > best->bytes))
+				best = &agg[i];
+		}
+		if(best == NULL)
+			break;
+		if(rpc->add(ctx, "{", &th) < 0)
+			break;
+		rpc->struct_add(th, "ssssdjjjjd", "pool",
+				(best->pool == MEMPROF_PKG) ? "pkg" : "shm", "module",
+				best->mname ? best->mname : "", "file",
+				best->file ? best->file : "", "function",
+				best->func ? best->func : "", "line", best->line, "allocs",
+				best->allocs * mem_profile_rate, "bytes",
+				best->bytes * mem_profile_rate, "live",
+				best->live * mem_profile_rate, "allocs_per_sec",
+				best->allocs * mem_profile_rate / secs, "procs", best->procs);
+		best->allocs = 0;
+	}
+	pkg_free(agg);
+}
+
+#else /* DBG_SR_MEMORY */
+
+int memprof_init(int procs)
+{
+	if(mem_profile_rate > 0)
+		LM_WARN("memory profiler requires DBG_SR_MEMORY - not enabled\n");
+	return 0;
+}
+
+void memprof_rpc_top(rpc_t *rpc, void *ctx)
+{
+	rpc->fault(ctx, 500, "Memory profiler not available");
+}
+
+#endif /* DBG_SR_MEMORY */
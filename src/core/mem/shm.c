@@ -37,6 +37,10 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 
+#else
+
+#include <sys/shm.h>
+
 #endif
 
 #include "memcore.h"
@@ -57,6 +61,46 @@ static int _shm_core_shmid[SHM_CORE_POOLS_SIZE] = {-1}; /*shared memory id*/
 static void *_shm_core_pools_mem[SHM_CORE_POOLS_SIZE] = {(void *)-1};
 static int _shm_core_pools_num = 1;
 
+/* size of the shm pools mapping (shm_mem_size rounded up to page size) */
+static unsigned long _shm_core_map_size = 0;
+/* huge pages mode in effect: 0 - none, 1 - hugetlb, 2 - transparent */
+static int _shm_core_huge_pages = 0;
+/* set if the pages were pre-faulted by the kernel on mapping */
+static int _shm_core_populated = 0;
+
+/**
+ * get the size of huge pages, as reported by the system
+ */
+static unsigned long shm_huge_page_size(void)
+{
+	unsigned long sz;
+	char line[128];
+	FILE *f;
+
+	sz = 0;
+	f = fopen("/proc/meminfo", "r");
+	if(f != NULL) {
+		while(fgets(line, sizeof(line), f) != NULL) {
+			if(sscanf(line, "Hugepagesize: %lu kB", &sz) == 1) {
+				sz *= 1024;
+				break;
+			}
+		}
+		fclose(f);
+	}
+	if(sz == 0 || (sz & (sz - 1)) != 0)
+		sz = 2 * 1024 * 1024;
+	return sz;
+}
+
+/**
+ * huge pages mode in effect for shm (0 - none, 1 - hugetlb, 2 - thp)
+ */
+int shm_core_huge_pages(void)
+{
+	return _shm_core_huge_pages;
+}
+
 sr_shm_api_t _shm_root = {0};
 
 /**
@@ -67,7 +111,9 @@ int shm_core_pools_init(void)
 	int i;
 	int pinit;
 
+	unsigned long hpsize;
 #ifdef SHM_MMAP
+	int mflags;
 #ifndef USE_ANON_MMAP
 	int fd;
 #endif
@@ -101,26 +147,85 @@ int shm_core_pools_init(void)
 		LM_DBG("preparing to initialize shm core pools\n");
 	}
 
+	hpsize = (shm_huge_pages == 1) ? shm_huge_page_size() : 0;
 	for(i = 0; i < _shm_core_pools_num; i++) {
+		_shm_core_map_size = shm_mem_size;
 #ifdef SHM_MMAP
+		mflags = 0;
+#ifdef MAP_POPULATE
+		/* let the kernel pre-fault the pages */
+		if(shm_force_alloc)
+			mflags |= MAP_POPULATE;
+#endif
+		_shm_core_pools_mem[i] = (void *)-1;
+#ifdef MAP_HUGETLB
+		if(hpsize) {
+			_shm_core_map_size = (shm_mem_size + hpsize - 1) & ~(hpsize - 1);
+			_shm_core_pools_mem[i] = mmap(0, _shm_core_map_size,
+					PROT_READ | PROT_WRITE,
+					MAP_ANON | MAP_SHARED | MAP_HUGETLB | mflags, -1, 0);
+			if(_shm_core_pools_mem[i] == (void *)-1) {
+				LM_WARN("could not map shm pool[%d] on huge pages (%s) - "
+						"using normal pages\n",
+						i, strerror(errno));
+				_shm_core_map_size = shm_mem_size;
+			} else {
+				_shm_core_huge_pages = 1;
+			}
+		}
+#endif
+		if(_shm_core_pools_mem[i] == (void *)-1) {
 #ifdef USE_ANON_MMAP
-		_shm_core_pools_mem[i] = mmap(0, shm_mem_size, PROT_READ | PROT_WRITE,
-				MAP_ANON | MAP_SHARED, -1, 0);
+			_shm_core_pools_mem[i] = mmap(0, shm_mem_size,
+					PROT_READ | PROT_WRITE, MAP_ANON | MAP_SHARED | mflags, -1,
+					0);
 #else
-		fd = open("/dev/zero", O_RDWR);
-		if(fd == -1) {
-			LOG(L_CRIT, "could not open /dev/zero [%d]: %s\n", i,
-					strerror(errno));
-			return -1;
-		}
-		_shm_core_pools_mem[i] = mmap(
-				0, shm_mem_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-		/* close /dev/zero */
-		close(fd);
+			fd = open("/dev/zero", O_RDWR);
+			if(fd == -1) {
+				LOG(L_CRIT, "could not open /dev/zero [%d]: %s\n", i,
+						strerror(errno));
+				return -1;
+			}
+			_shm_core_pools_mem[i] = mmap(0, shm_mem_size,
+					PROT_READ | PROT_WRITE, MAP_SHARED | mflags, fd, 0);
+			/* close /dev/zero */
+			close(fd);
 #endif /* USE_ANON_MMAP */
+#ifdef MADV_HUGEPAGE
+			if(shm_huge_pages == 2 && _shm_core_pools_mem[i] != (void *)-1) {
+				if(madvise(_shm_core_pools_mem[i], shm_mem_size, MADV_HUGEPAGE)
+						== 0) {
+					_shm_core_huge_pages = 2;
+				} else {
+					LM_WARN("transparent huge pages not available for shm"
+							" pool[%d]: %s\n",
+							i, strerror(errno));
+				}
+			}
+#endif
+		}
+		if(mflags && _shm_core_pools_mem[i] != (void *)-1)
+			_shm_core_populated = 1;
 #else
 
-		_shm_core_shmid[i] = shmget(IPC_PRIVATE, shm_mem_size, 0700);
+		_shm_core_shmid[i] = -1;
+#ifdef SHM_HUGETLB
+		if(hpsize) {
+			_shm_core_map_size = (shm_mem_size + hpsize - 1) & ~(hpsize - 1);
+			_shm_core_shmid[i] = shmget(
+					IPC_PRIVATE, _shm_core_map_size, 0700 | SHM_HUGETLB);
+			if(_shm_core_shmid[i] == -1) {
+				LM_WARN("could not allocate shm segment[%d] on huge pages"
+						" (%s) - using normal pages\n",
+						i, strerror(errno));
+				_shm_core_map_size = shm_mem_size;
+			} else {
+				_shm_core_huge_pages = 1;
+			}
+		}
+#endif
+		if(_shm_core_shmid[i] == -1)
+			_shm_core_shmid[i] = shmget(IPC_PRIVATE, shm_mem_size, 0700);
 		if(_shm_core_shmid[i] == -1) {
 			LOG(L_CRIT, "could not allocate shared memory segment[%d]: %s\n", i,
 					strerror(errno));
@@ -155,7 +260,7 @@ void *shm_core_get_pool(void)
 		return NULL;
 
 	for(i = 0; i < _shm_core_pools_num; i++) {
-		if(shm_force_alloc) {
+		if(shm_force_alloc && !_shm_core_populated) {
 			sz = sysconf(_SC_PAGESIZE);
 			DBG("%ld bytes/page\n", sz);
 			if((sz < sizeof(*p)) || (_ROUND_LONG(sz) != sz)) {
@@ -209,7 +314,7 @@ void shm_core_destroy(void)
 	for(i = 0; i < _shm_core_pools_num; i++) {
 		if(_shm_core_pools_mem[i] != (void *)-1) {
 #ifdef SHM_MMAP
-			munmap(_shm_core_pools_mem[i], /* SHM_MEM_SIZE */ shm_mem_size);
+			munmap(_shm_core_pools_mem[i], _shm_core_map_size);
 #else
 			shmdt(_shm_core_pools_mem[i]);
 #endif
@@ -121,6 +121,7 @@ void shm_destroy_manager(void);
 void shm_print_manager(void);
 
 int shm_address_in(void *p);
+int shm_core_huge_pages(void);
 
 #define shm_available_safe() shm_available()
 #define shm_malloc_on_fork() \
@@ -20,6 +20,12 @@
  * @ingroup core
  */
 
+#ifdef __OS_linux
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* for sched_setaffinity() */
+#endif
+#include <sched.h>
+#endif
 
 #include "pt.h"
 #include "tcp_init.h"
@@ -66,6 +72,137 @@ unsigned int set_fork_delay(unsigned int v)
 	return r;
 }
 
+/* cpu lists for process affinity (core parameters) */
+char *ksr_cpu_affinity_workers = NULL;
+char *ksr_cpu_affinity_others = NULL;
+
+/* round robin position in each affinity group (updated in main) */
+static int _ksr_cpu_affinity_pos[2] = {0, 0};
+
+#ifdef __OS_linux
+/**
+ * get the idx-th cpu (modulo the number of cpus) from a list like "0-3,8"
+ * @return the cpu number, -1 on error
+ */
+static int ksr_cpu_list_get(char *list, int idx)
+{
+	char *p;
+	char *end;
+	long a, b;
+	int n;
+	int pass;
+
+	n = 0;
+	for(pass = 0; pass < 2; pass++) {
+		p = list;
+		while(*p) {
+			a = strtol(p, &end, 10);
+			if(end == p || a < 0 || a >= CPU_SETSIZE)
+				goto error;
+			b = a;
+			p = end;
+			if(*p == '-') {
+				p++;
+				b = strtol(p, &end, 10);
+				if(end == p || b < a || b >= CPU_SETSIZE)
+					goto error;
+				p = end;
+			}
+			if(pass == 1 && idx <= b - a)
+				return (int)(a + idx);
+			if(pass == 1)
+				idx -= b - a + 1;
+			else
+				n += b - a + 1;
+			if(*p == ',')
+				p++;
+			else if(*p != '\0')
+				goto error;
+		}
+		if(n == 0)
+			goto error;
+		idx %= n;
+	}
+
+error:
+	LM_ERR("invalid cpu list [%s]\n", list);
+	return -1;
+}
+#endif
+
+/**
+ * select the cpu for the next forked process - SIP workers (rank > 0) and
+ * the other processes take cpus in round robin from their own list
+ * @return the cpu number, -1 if no affinity has to be set
+ */
+static int ksr_cpu_affinity_next(int child_id)
+{
+#ifdef __OS_linux
+	char *list;
+	int grp;
+	int cpu;
+
+	grp = (child_id > 0) ? 0 : 1;
+	list = (grp == 0) ? ksr_cpu_affinity_workers : ksr_cpu_affinity_others;
+	if(list == NULL || *list == '\0')
+		return -1;
+	cpu = ksr_cpu_list_get(list, _ksr_cpu_affinity_pos[grp]);
+	if(cpu >= 0)
+		_ksr_cpu_affinity_pos[grp]++;
+	return cpu;
+#else
+	return -1;
+#endif
+}
+
+/**
+ * check the cpu affinity lists - to be called once at startup, before
+ * forking, so that a malformed list stops the startup
+ * @return 0 if the lists are valid (or not set), -1 on error
+ */
+int ksr_cpu_affinity_check(void)
+{
+	char *lists[2];
+	int i;
+
+	lists[0] = ksr_cpu_affinity_workers;
+	lists[1] = ksr_cpu_affinity_others;
+	for(i = 0; i < 2; i++) {
+		if(lists[i] == NULL || *lists[i] == '\0')
+			continue;
+#ifdef __OS_linux
+		if(ksr_cpu_list_get(lists[i], 0) < 0)
+			return -1;
+#else
+		LM_WARN("cpu affinity not supported on this OS - ignoring [%s]\n",
+				lists[i]);
+#endif
+	}
+	return 0;
+}
+
+/**
+ * pin the current process to a cpu
+ */
+static void ksr_cpu_affinity_set(int cpu)
+{
+#ifdef __OS_linux
+	cpu_set_t cset;
+
+	if(cpu < 0)
+		return;
+	CPU_ZERO(&cset);
+	CPU_SET(cpu, &cset);
+	if(sched_setaffinity(0, sizeof(cset), &cset) < 0) {
+		LM_WARN("failed to set affinity to cpu %d for process %d: %s\n", cpu,
+				process_no, strerror(errno));
+		pt[process_no].cpu = -1;
+		return;
+	}
+	LM_DBG("process %d pinned to cpu %d\n", process_no, cpu);
+#endif
+}
+
 /* number of known "common" used fds */
 static int calc_common_open_fds_no(void)
 {
@@ -89,9 +226,7 @@ static int calc_common_open_fds_no(void)
 /* returns 0 on success, -1 on error */
 int init_pt(int proc_no)
 {
-#ifdef USE_TCP
 	int r;
-#endif
 
 	LM_DBG("registering new processes: %d (old) + %d (new) = %d (total)\n",
 			estimated_proc_no, proc_no, estimated_proc_no + proc_no);
@@ -107,12 +242,13 @@ int init_pt(int proc_no)
 		return -1;
 	}
 	memset(pt, 0, sizeof(struct process_table) * estimated_proc_no);
-#ifdef USE_TCP
 	for(r = 0; r < estimated_proc_no; r++) {
+#ifdef USE_TCP
 		pt[r].unix_sock = -1;
 		pt[r].idx = -1;
-	}
 #endif
+		pt[r].cpu = -1;
+	}
 	process_no = 0; /*main process number*/
 	pt[process_no].pid = getpid();
 	pt[process_no].rank = PROC_MAIN;
@@ -245,6 +381,7 @@ int fork_process(int child_id, char *desc, int make_sock)
 {
 	int pid, child_process_no;
 	int ret;
+	int cpu;
 #ifdef USE_TCP
 	int sockfd[2];
 #endif
@@ -281,6 +418,8 @@ int fork_process(int child_id, char *desc, int make_sock)
 		goto error;
 	}
 	child_process_no = *process_count;
+	cpu = ksr_cpu_affinity_next(child_id);
+	pt[child_process_no].cpu = cpu;
 	pid = fork();
 	if(pid < 0) {
 		lock_release(process_lock);
@@ -290,6 +429,7 @@ int fork_process(int child_id, char *desc, int make_sock)
 		/* child */
 		_ksr_is_main = 0; /* a forked process cannot be the "main" one */
 		process_no = child_process_no;
+		ksr_cpu_affinity_set(cpu);
 		daemon_status_on_fork_cleanup();
 		/* close tcp unix sockets if this is not tcp main */
 #ifdef USE_TCP
@@ -394,6 +534,7 @@ int fork_tcp_process(int child_id, char *desc, int r, int *reader_fd_1)
 	int i;
 	unsigned int new_seed1;
 	unsigned int new_seed2;
+	int cpu;
 
 	/* init */
 	sockfd[0] = sockfd[1] = -1;
@@ -433,6 +574,8 @@ int fork_tcp_process(int child_id, char *desc, int r, int *reader_fd_1)
 	child_process_no = *process_count;
 	new_seed1 = kam_rand();
 	new_seed2 = random();
+	cpu = ksr_cpu_affinity_next(child_id);
+	pt[child_process_no].cpu = cpu;
 	pid = fork();
 	if(pid < 0) {
 		lock_release(process_lock);
@@ -442,6 +585,7 @@ int fork_tcp_process(int child_id, char *desc, int r, int *reader_fd_1)
 	if(pid == 0) {
 		_ksr_is_main = 0; /* a forked process cannot be the "main" one */
 		process_no = child_process_no;
+		ksr_cpu_affinity_set(cpu);
 		/* close unneeded unix sockets */
 		close_extra_socks(child_id, process_no);
 		/* same for unneeded tcp_children <-> tcp_main unix socks */
@@ -43,6 +43,7 @@ struct process_table
 #endif
 	int status; /* set to 1 when child init is done */
 	int rank;	/* rank of process */
+	int cpu;	/* cpu the process is pinned to, -1 if none */
 	char desc[MAX_PT_DESC];
 };
 
@@ -54,6 +55,7 @@ extern int process_no;
 extern struct tcp_child *tcp_children;
 
 int init_pt(int proc_no);
+int ksr_cpu_affinity_check(void);
 int get_max_procs(void);
 int register_procs(int no);
 int get_max_open_fds(void);
@@ -46,6 +46,7 @@
 #include "ppcfg.h"
 #include "fmsg.h"
 #include "async_task.h"
+#include "dns_cache.h"
 #include "shm_init.h"
 #include "str_list.h"
 #include "daemonize.h"
@@ -1009,6 +1010,11 @@ int init_child(int rank)
 			return -1;
 		}
 	}
+#ifdef USE_DNS_CACHE
+	if(dns_cache_prefetch_child_init(rank) < 0) {
+		return -1;
+	}
+#endif
 
 	ret = init_mod_child(_ksr_modules_list, rank);
 	if(rank != PROC_INIT && rank != PROC_POSTCHILDINIT) {
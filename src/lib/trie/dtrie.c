@@ -45,31 +45,39 @@
 #include "../../core/mem/mem.h"
 
 
-struct dtrie_node_t *dtrie_init(const unsigned int branches)
+/*!
+ * \brief Allocates a node together with its children pointer array
+ *
+ * The children array follows the node in the same memory block, saving
+ * one allocation (and its overhead) per node and keeping the node and its
+ * children pointers next to each other.
+ * \param branches number of branches in the trie
+ * \return pointer to the new node on success, NULL otherwise
+ */
+static struct dtrie_node_t *dtrie_node_new(const unsigned int branches)
 {
-	struct dtrie_node_t *root;
+	struct dtrie_node_t *node;
+	size_t size;
 
-	root = shm_malloc(sizeof(struct dtrie_node_t));
-	if(root == NULL) {
+	size = sizeof(struct dtrie_node_t)
+		   + sizeof(struct dtrie_node_t *) * branches;
+	node = shm_malloc(size);
+	if(node == NULL) {
 		SHM_MEM_ERROR;
 		return NULL;
 	}
-	LM_DBG("allocate %lu bytes for root at %p\n",
-			(long unsigned)sizeof(struct dtrie_node_t), root);
-	memset(root, 0, sizeof(struct dtrie_node_t));
+	LM_DBG("allocate %lu bytes for node with %d children at %p\n",
+			(long unsigned)size, branches, node);
+	memset(node, 0, size);
+	node->child = (struct dtrie_node_t **)(node + 1);
 
-	root->child = shm_malloc(sizeof(struct dtrie_node_t *) * branches);
-	if(root->child == NULL) {
-		shm_free(root);
-		SHM_MEM_ERROR;
-		return NULL;
-	}
-	LM_DBG("allocate %lu bytes for %d root children pointer at %p\n",
-			(long unsigned)sizeof(struct dtrie_node_t *) * branches, branches,
-			root->child);
-	memset(root->child, 0, sizeof(struct dtrie_node_t *) * branches);
+	return node;
+}
 
-	return root;
+
+struct dtrie_node_t *dtrie_init(const unsigned int branches)
+{
+	return dtrie_node_new(branches);
 }
 
 
@@ -96,8 +104,6 @@ void dtrie_delete(struct dtrie_node_t *root, struct dtrie_node_t *node,
 
 	if(node != root) {
 		LM_DBG("free node at %p\n", node);
-		shm_free(node->child);
-		node->child = NULL;
 		shm_free(node);
 	}
 }
@@ -109,7 +115,6 @@ void dtrie_destroy(struct dtrie_node_t **root, dt_delete_func_t delete_payload,
 	if((root != NULL) && (*root != NULL)) {
 		dtrie_delete(*root, *root, delete_payload, branches);
 		LM_DBG("free root at %p\n", root);
-		shm_free((*root)->child);
 		shm_free(*root);
 		*root = NULL;
 	}
@@ -151,30 +156,10 @@ int dtrie_insert(struct dtrie_node_t *root, const char *number,
 		}
 
 		if(node->child[digit] == NULL) {
-			node->child[digit] = shm_malloc(sizeof(struct dtrie_node_t));
+			node->child[digit] = dtrie_node_new(branches);
 			if(node->child[digit] == NULL) {
-				SHM_MEM_ERROR;
-				return -1;
-			}
-
-			LM_DBG("allocate %lu bytes for node at %p\n",
-					(long unsigned)sizeof(struct dtrie_node_t),
-					node->child[digit]);
-			memset(node->child[digit], 0, sizeof(struct dtrie_node_t));
-
-			node->child[digit]->child =
-					shm_malloc(sizeof(struct dtrie_node_t *) * branches);
-			if(node->child[digit]->child == NULL) {
-				SHM_MEM_ERROR;
-				shm_free(node->child[digit]);
-				node->child[digit] = NULL;
 				return -1;
 			}
-			LM_DBG("allocate %lu bytes for %d root children pointer at %p\n",
-					(long unsigned)sizeof(struct dtrie_node_t *) * branches,
-					branches, node->child[digit]->child);
-			memset(node->child[digit]->child, 0,
-					sizeof(struct dtrie_node_t *) * branches);
 		}
 		node = node->child[digit];
 		i++;
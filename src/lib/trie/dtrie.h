@@ -43,10 +43,10 @@
 #define _DTRIE_H_
 
 
-/*! Trie node */
+/*! Trie node, allocated in one block with its children array */
 struct dtrie_node_t
 {
-	struct dtrie_node_t **child; /*!< children */
+	struct dtrie_node_t **child; /*!< children, stored after the node */
 	void *data;					 /*!< custom data */
 };
 
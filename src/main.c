@@ -81,6 +81,7 @@
 #include "core/globals.h"
 #include "core/mem/mem.h"
 #include "core/mem/shm_mem.h"
+#include "core/mem/memprof.h"
 #include "core/shm_init.h"
 #include "core/sr_module.h"
 #include "core/modparam.h"
@@ -438,6 +439,8 @@ int shm_force_alloc = 0; /* force immediate (on startup) page allocation
 						  (by writing 0 in the pages), useful if
 						  mlock_pages is also 1 */
 int mlock_pages = 0;	 /* default off, try to disable swapping */
+int shm_huge_pages = 0;	 /* back shm with huge pages: 0 - no, 1 - hugetlb,
+						  2 - transparent huge pages */
 
 /* real time options */
 int real_time = 0; /* default off, flags: 1 on only timer, 2  slow timer,
@@ -3376,6 +3379,10 @@ int main(int argc, char **argv)
 	 * processes registered from the modules*/
 	if(init_pt(calc_proc_no()) == -1)
 		goto error;
+	if(ksr_cpu_affinity_check() < 0) {
+		LM_CRIT("invalid cpu_affinity_workers or cpu_affinity_others\n");
+		goto error;
+	}
 #ifdef USE_TCP
 #ifdef USE_TLS
 	if(!tls_disable) {
@@ -3418,6 +3425,10 @@ int main(int argc, char **argv)
 		goto error;
 	}
 #endif
+	if(memprof_init(get_max_procs()) < 0) {
+		LM_CRIT("could not initialize the memory profiler\n");
+		goto error;
+	}
 
 	if(ksr_tcp_main_threads != 0) {
 		if(ksr_tcpx_proc_list_init() < 0) {
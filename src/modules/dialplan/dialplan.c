@@ -793,12 +793,53 @@ static void dialplan_rpc_dump(rpc_t *rpc, void *ctx)
 
 static const char *dialplan_rpc_dump_doc[2] = {"Dump dialplan content", 0};
 
+/*
+ * RPC command to print the match stats of a dialplan id
+ */
+static void dialplan_rpc_stats(rpc_t *rpc, void *ctx)
+{
+	dpl_id_p idp;
+	int dpid;
+	void *th;
+
+	if(rpc->scan(ctx, "d", &dpid) < 1) {
+		rpc->fault(ctx, 500, "Missing parameter");
+		return;
+	}
+
+	if((idp = select_dpid(dpid)) == 0) {
+		LM_ERR("no information available for dpid %i\n", dpid);
+		rpc->fault(ctx, 500, "Dialplan ID not matched");
+		return;
+	}
+
+	if(rpc->add(ctx, "{", &th) < 0) {
+		rpc->fault(ctx, 500, "Internal error root reply");
+		return;
+	}
+
+	if(rpc->struct_add(th, "dJJJJJ", "DPID", dpid, "LOOKUPS",
+			   (uint64_t)idp->st_lookups, "MATCHES", (uint64_t)idp->st_matches,
+			   "RULES", (uint64_t)idp->st_rules, "REGEX",
+			   (uint64_t)idp->st_regex, "SKIPPED", (uint64_t)idp->st_skipped)
+			< 0) {
+		rpc->fault(ctx, 500, "Internal error adding stats");
+		return;
+	}
+
+	return;
+}
+
+static const char *dialplan_rpc_stats_doc[2] = {
+		"Print the matching stats of a dialplan id", 0};
+
 
 rpc_export_t dialplan_rpc_list[] = {
 		{"dialplan.reload", dialplan_rpc_reload, dialplan_rpc_reload_doc, 0},
 		{"dialplan.translate", dialplan_rpc_translate,
 				dialplan_rpc_translate_doc, 0},
 		{"dialplan.dump", dialplan_rpc_dump, dialplan_rpc_dump_doc, 0},
+		{"dialplan.stats", dialplan_rpc_stats, dialplan_rpc_stats_doc, 0},
 		{0, 0, 0, 0}};
 
 static int dialplan_init_rpc(void)
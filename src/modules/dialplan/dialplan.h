@@ -46,6 +46,8 @@
 #define DP_TFLAGS_PV_MATCH (1 << 0)
 #define DP_TFLAGS_PV_SUBST (1 << 1)
 
+#define DP_MATCH_PFX_SIZE 16
+
 extern pcre2_general_context *dpl_gctx;
 extern pcre2_compile_context *dpl_ctx;
 
@@ -63,6 +65,8 @@ typedef struct dpl_node
 	struct subst_expr *repl_comp; /* compiled replacement */
 	str attrs;					  /* attributes string */
 	unsigned int tflags;		  /* flags for type of values for matching */
+	char mpfx[DP_MATCH_PFX_SIZE]; /* literal prefix required by match regex */
+	int mpfxlen;				  /* literal prefix length */
 
 	struct dpl_node *next; /* next rule */
 } dpl_node_t, *dpl_node_p;
@@ -82,6 +86,11 @@ typedef struct dpl_id
 {
 	int dp_id;
 	dpl_index_t *first_index; /*fast access :rules with specific length*/
+	long st_lookups;		  /* translations done */
+	long st_matches;		  /* translations with a matching rule */
+	long st_rules;			  /* rules tested */
+	long st_regex;			  /* regular expressions executed */
+	long st_skipped;		  /* regex rules skipped by literal prefix */
 	struct dpl_id *next;
 } dpl_id_t, *dpl_id_p;
 
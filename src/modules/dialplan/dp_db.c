@@ -449,6 +449,74 @@ pcre2_code *reg_ex_comp(const char *pattern, int *cap_cnt, int mtype)
 }
 
 
+/* get the literal prefix that an input must have to match an anchored
+ * regular expression (e.g., '^\+4930[0-9]+' requires '+4930'), copy at most
+ * size chars in pfx and return the length, 0 if there is none */
+static int dpl_regex_prefix(str *mexp, char *pfx, int size)
+{
+	char *p;
+	char *end;
+	int depth;
+	int inclass;
+	int n;
+	int last;
+
+	if(mexp->s == NULL || mexp->len < 2 || mexp->s[0] != '^')
+		return 0;
+
+	/* top level alternatives do not share the prefix */
+	end = mexp->s + mexp->len;
+	depth = 0;
+	inclass = 0;
+	for(p = mexp->s; p < end; p++) {
+		if(*p == '\\') {
+			p++;
+			continue;
+		}
+		if(inclass) {
+			if(*p == ']')
+				inclass = 0;
+			continue;
+		}
+		switch(*p) {
+			case '[':
+				inclass = 1;
+				break;
+			case '(':
+				depth++;
+				break;
+			case ')':
+				depth--;
+				break;
+			case '|':
+				if(depth <= 0)
+					return 0;
+				break;
+		}
+	}
+
+	n = 0;
+	last = 0;
+	for(p = mexp->s + 1; p < end && n < size; p++) {
+		if(*p == '\\') {
+			/* escaped non-alphanumeric char is a literal */
+			if(p + 1 >= end
+					|| (p[1] >= '0' && p[1] <= '9') || (p[1] >= 'a' && p[1] <= 'z')
+					|| (p[1] >= 'A' && p[1] <= 'Z'))
+				break;
+			p++;
+		} else if(strchr("^$.[|()?*+{", *p) != NULL) {
+			break;
+		}
+		last = n;
+		pfx[n++] = *p;
+	}
+	/* a quantifier can make the last literal optional */
+	if(n > 0 && p < end && (*p == '?' || *p == '*' || *p == '{'))
+		n = last;
+	return n;
+}
+
 /*compile the expressions, and if ok, build the rule */
 dpl_node_t *build_rule(db_val_t *values)
 {
@@ -570,6 +638,10 @@ dpl_node_t *build_rule(db_val_t *values)
 	new_rule->subst_comp = subst_comp;
 	new_rule->repl_comp = repl_comp;
 	new_rule->tflags = tflags;
+	if(matchop == DP_REGEX_OP && !(tflags & DP_TFLAGS_PV_MATCH)) {
+		new_rule->mpfxlen = dpl_regex_prefix(
+				&new_rule->match_exp, new_rule->mpfx, DP_MATCH_PFX_SIZE);
+	}
 
 	return new_rule;
 
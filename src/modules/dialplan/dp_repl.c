@@ -36,6 +36,7 @@
 #include "../../core/re.h"
 #include "../../core/str_list.h"
 #include "../../core/mem/shm_mem.h"
+#include "../../core/atomic_ops.h"
 #include "dialplan.h"
 
 typedef struct dpl_dyn_pcre
@@ -595,6 +596,18 @@ error:
 
 #define DP_MAX_ATTRS_LEN 255
 static char dp_attrs_buf[DP_MAX_ATTRS_LEN + 1];
+
+/* update the match cost stats of the dialplan id */
+#define dp_stats_update(idp, matched, nrules, nregex, nskipped) \
+	do {                                                         \
+		atomic_inc_long(&(idp)->st_lookups);                     \
+		if(matched)                                              \
+			atomic_inc_long(&(idp)->st_matches);                 \
+		atomic_add_long(&(idp)->st_rules, (nrules));             \
+		atomic_add_long(&(idp)->st_regex, (nregex));             \
+		atomic_add_long(&(idp)->st_skipped, (nskipped));         \
+	} while(0)
+
 int dp_translate_helper(
 		sip_msg_t *msg, str *input, str *output, dpl_id_p idp, str *attrs)
 {
@@ -605,6 +618,9 @@ int dp_translate_helper(
 	char b;
 	dpl_dyn_pcre_p re_list = NULL;
 	dpl_dyn_pcre_p rt = NULL;
+	int nrules = 0;
+	int nregex = 0;
+	int nskipped = 0;
 
 	if(!input || !input->s || !input->len) {
 		LM_WARN("invalid or empty input string to be matched\n");
@@ -618,6 +634,7 @@ int dp_translate_helper(
 
 	if(!indexp || (indexp != NULL && !indexp->first_rule)) {
 		LM_DBG("no rule for len %i\n", input->len);
+		dp_stats_update(idp, 0, 0, 0, 0);
 		return -1;
 	}
 
@@ -631,11 +648,22 @@ int dp_translate_helper(
 
 search_rule:
 	for(rulep = indexp->first_rule; rulep != NULL; rulep = rulep->next) {
+		nrules++;
 		switch(rulep->matchop) {
 
 			case DP_REGEX_OP:
 				LM_DBG("regex operator testing over [%.*s]\n", input->len,
 						input->s);
+				if(rulep->mpfxlen > 0
+						&& (input->len < rulep->mpfxlen
+								|| memcmp(input->s, rulep->mpfx, rulep->mpfxlen)
+										   != 0)) {
+					/* literal prefix of the regex not matching */
+					nskipped++;
+					rez = -1;
+					break;
+				}
+				nregex++;
 				if(rulep->tflags & DP_TFLAGS_PV_MATCH) {
 					re_list = dpl_dynamic_pcre_list(msg, &rulep->match_exp);
 					if(re_list == NULL) {
@@ -707,9 +735,11 @@ search_rule:
 	}
 
 	LM_DBG("no matching rule\n");
+	dp_stats_update(idp, 0, nrules, nregex, nskipped);
 	return -1;
 
 repl:
+	dp_stats_update(idp, 1, nrules, nregex, nskipped);
 	LM_DBG("found a matching rule %p: pr %i, match_exp %.*s\n", rulep,
 			rulep->pr, rulep->match_exp.len, rulep->match_exp.s);
 
@@ -84,6 +84,8 @@
 #define DS_ALG_LATENCY 13
 #define DS_ALG_RRSERIAL 14
 #define DS_ALG_PRIORITY_WEIGHT 15
+#define DS_ALG_CHASHCALLID 16
+#define DS_ALG_CHASHPV 17
 #define DS_ALG_OVERLOAD 64 /* 2^6 - can be also used as a flag */
 
 #define DS_HN_SIZE 256
@@ -129,12 +131,31 @@ extern int ds_load_mode;
 extern uint32_t ds_dns_mode;
 extern int ds_dns_ttl;
 extern int ds_event_callback_mode;
+extern int ds_ping_spread;
 
 static db_func_t ds_dbf;
 static db1_con_t *ds_db_handle = NULL;
 
 static ds_set_t **ds_lists = NULL;
 
+/* index of destination records by ip address, one for each list */
+typedef struct _ds_addr_item
+{
+	ds_set_t *node;
+	int idx;
+	unsigned int hashid;
+	struct _ds_addr_item *next;
+} ds_addr_item_t;
+
+typedef struct _ds_addr_index
+{
+	unsigned int size;
+	ds_addr_item_t **slots;
+	ds_addr_item_t *items;
+} ds_addr_index_t;
+
+static ds_addr_index_t **ds_addr_lists = NULL;
+
 static int *ds_list_nr = NULL;
 static int *ds_crt_idx = NULL;
 static int *ds_next_idx = NULL;
@@ -319,9 +340,18 @@ int ds_init_data(void)
 	}
 	memset(ds_lists, 0, 2 * sizeof(ds_set_t *));
 
+	ds_addr_lists =
+			(ds_addr_index_t **)shm_malloc(2 * sizeof(ds_addr_index_t *));
+	if(!ds_addr_lists) {
+		shm_free(ds_lists);
+		SHM_MEM_ERROR;
+		return -1;
+	}
+	memset(ds_addr_lists, 0, 2 * sizeof(ds_addr_index_t *));
 
 	p = (int *)shm_malloc(3 * sizeof(int));
 	if(!p) {
+		shm_free(ds_addr_lists);
 		shm_free(ds_lists);
 		SHM_MEM_ERROR;
 		return -1;
@@ -1208,6 +1238,106 @@ err1:
 	return -1;
 }
 
+/**
+ * hash id of an ip address for the index
+ */
+static inline unsigned int ds_addr_hashid(struct ip_addr *ip)
+{
+	return get_hash1_raw((char *)ip->u.addr, ip->len);
+}
+
+/**
+ * count the destination records in the tree of sets
+ */
+static int ds_addr_index_count(ds_set_t *node)
+{
+	if(!node)
+		return 0;
+	return node->nr + ds_addr_index_count(node->next[0])
+		   + ds_addr_index_count(node->next[1]);
+}
+
+/**
+ * fill the items in the order used by ds_is_addr_from_set_r()
+ */
+static void ds_addr_index_fill(ds_set_t *node, ds_addr_item_t *items, int *n)
+{
+	int i;
+
+	if(!node)
+		return;
+	for(i = 0; i < 2; ++i) {
+		ds_addr_index_fill(node->next[i], items, n);
+	}
+	for(i = 0; i < node->nr; i++) {
+		if(node->dlist[i].irmode & DS_IRMODE_NOIPADDR) {
+			/* dst record using hostname with dns not done - no ip to match */
+			continue;
+		}
+		items[*n].node = node;
+		items[*n].idx = i;
+		items[*n].hashid = ds_addr_hashid(&node->dlist[i].ip_address);
+		(*n)++;
+	}
+}
+
+/**
+ * build the ip address index for the list with the given position,
+ * replacing the old index at that position
+ * - the index is used to match the source address without scanning all
+ *   the destination records, when the address of the records does not
+ *   change at runtime (i.e., dns is not done always or on timer)
+ */
+static void ds_addr_index_build(int list_idx)
+{
+	ds_addr_index_t *dsi;
+	unsigned int size;
+	int nitems;
+	int n;
+	int i;
+
+	if(ds_addr_lists[list_idx] != NULL) {
+		shm_free(ds_addr_lists[list_idx]);
+		ds_addr_lists[list_idx] = NULL;
+	}
+	if(ds_dns_mode & (DS_DNS_MODE_ALWAYS | DS_DNS_MODE_TIMER)) {
+		return;
+	}
+	nitems = ds_addr_index_count(ds_lists[list_idx]);
+	if(nitems <= 0) {
+		return;
+	}
+	for(size = 16; size < (unsigned int)nitems && size < (1 << 20);
+			size <<= 1)
+		;
+
+	dsi = (ds_addr_index_t *)shm_malloc(sizeof(ds_addr_index_t)
+										+ size * sizeof(ds_addr_item_t *)
+										+ nitems * sizeof(ds_addr_item_t));
+	if(dsi == NULL) {
+		SHM_MEM_ERROR;
+		LM_WARN("matching addresses without index\n");
+		return;
+	}
+	memset(dsi, 0,
+			sizeof(ds_addr_index_t) + size * sizeof(ds_addr_item_t *)
+					+ nitems * sizeof(ds_addr_item_t));
+	dsi->size = size;
+	dsi->slots = (ds_addr_item_t **)((char *)dsi + sizeof(ds_addr_index_t));
+	dsi->items = (ds_addr_item_t *)((char *)dsi->slots
+									+ size * sizeof(ds_addr_item_t *));
+
+	n = 0;
+	ds_addr_index_fill(ds_lists[list_idx], dsi->items, &n);
+	/* link from last to first to keep the order of the records per slot */
+	for(i = n - 1; i >= 0; i--) {
+		dsi->items[i].next = dsi->slots[dsi->items[i].hashid & (size - 1)];
+		dsi->slots[dsi->items[i].hashid & (size - 1)] = &dsi->items[i];
+	}
+	ds_addr_lists[list_idx] = dsi;
+	LM_DBG("ip address index built with %d records in %u slots\n", n, size);
+}
+
 /*! \brief load groups of destinations from file */
 int ds_load_list(char *lfile)
 {
@@ -1351,6 +1481,8 @@ int ds_load_list(char *lfile)
 		goto error;
 	}
 
+	ds_addr_index_build(*ds_next_idx);
+
 	fclose(f);
 	f = NULL;
 	/* Update list - should it be sync'ed? */
@@ -1679,6 +1811,8 @@ int ds_load_db(void)
 		goto err2;
 	}
 
+	ds_addr_index_build(*ds_next_idx);
+
 	ds_dbf.free_result(ds_db_handle, res);
 
 	/* update data - should it be sync'ed? */
@@ -1710,6 +1844,14 @@ int ds_destroy_list(void)
 		shm_free(ds_lists);
 	}
 
+	if(ds_addr_lists) {
+		if(ds_addr_lists[0])
+			shm_free(ds_addr_lists[0]);
+		if(ds_addr_lists[1])
+			shm_free(ds_addr_lists[1]);
+		shm_free(ds_addr_lists);
+	}
+
 	if(ds_crt_idx)
 		shm_free(ds_crt_idx);
 
@@ -2943,6 +3085,65 @@ int ds_manage_route_algo13(ds_set_t *idx, ds_select_state_t *rstate)
 	return hash;
 }
 
+/**
+ * jump consistent hash - map the key to a bucket in [0, n), only 1/n of the
+ * keys change the bucket when n is increased by one
+ * - John Lamping, Eric Veach, "A Fast, Minimal Memory, Consistent Hash
+ *   Algorithm"
+ */
+static inline int ds_jump_hash(uint64_t key, int n)
+{
+	int64_t b = -1;
+	int64_t j = 0;
+
+	while(j < n) {
+		b = j;
+		key = key * 2862933555777685757ULL + 1;
+		j = (int64_t)((b + 1)
+					  * ((double)(1LL << 31) / (double)((key >> 33) + 1)));
+	}
+	return (int)b;
+}
+
+#define DS_CHASH_ROUNDS 16
+
+/**
+ * select the destination by consistent hashing
+ * - when the destination is inactive, the key is salted and hashed again,
+ *   so only the calls of the inactive destination are moved and spread over
+ *   the remaining ones
+ * - return the index of the first active destination found, or of the first
+ *   choice if none is found, letting the caller to look for the next active
+ */
+static int ds_chash_select(ds_set_t *idx, unsigned int hash)
+{
+	int n;
+	int i;
+	int first;
+	int r;
+	uint64_t key;
+
+	if(ds_use_default != 0 && idx->nr != 1)
+		n = idx->nr - 1;
+	else
+		n = idx->nr;
+
+	key = (uint64_t)hash;
+	first = ds_jump_hash(key, n);
+	i = first;
+	for(r = 1; r <= DS_CHASH_ROUNDS && ds_skip_dst(idx->dlist[i].flags);
+			r++) {
+		key = (key ^ ((uint64_t)r * 0x9E3779B97F4A7C15ULL))
+			  * 0xBF58476D1CE4E5B9ULL;
+		key ^= key >> 31;
+		i = ds_jump_hash(key, n);
+	}
+	if(ds_skip_dst(idx->dlist[i].flags)) {
+		return first;
+	}
+	return i;
+}
+
 /**
  *
  */
@@ -3117,6 +3318,20 @@ int ds_manage_routes(
 			idx->pwlast = (idx->pwlast + 1) % 100;
 			lock_release(&idx->lock);
 			break;
+		case DS_ALG_CHASHCALLID: /* 16 - consistent hash over call-id */
+			if(ds_hash_callid(msg, &hash) != 0) {
+				LM_ERR("can't get callid hash\n");
+				return -1;
+			}
+			hash = ds_chash_select(idx, hash);
+			break;
+		case DS_ALG_CHASHPV: /* 17 - consistent hash over PV value */
+			if(ds_hash_pvar(msg, &hash) != 0) {
+				LM_ERR("can't get PV hash\n");
+				return -1;
+			}
+			hash = ds_chash_select(idx, hash);
+			break;
 		case DS_ALG_OVERLOAD: /* 64 - round robin with overload control */
 			lock_get(&idx->lock);
 			hash = idx->last;
@@ -3370,6 +3585,8 @@ int ds_add_dst(int group, str *address, int flags, int priority, str *attrs)
 		goto error;
 	}
 
+	ds_addr_index_build(*ds_next_idx);
+
 	_ds_list_nr = setn;
 	*ds_crt_idx = *ds_next_idx;
 
@@ -3441,6 +3658,8 @@ int ds_remove_dst(int group, str *address)
 		goto error;
 	}
 
+	ds_addr_index_build(*ds_next_idx);
+
 	_ds_list_nr = setn;
 	*ds_crt_idx = *ds_next_idx;
 
@@ -4272,6 +4491,71 @@ static int ds_set_vars(
 	return 1;
 }
 
+/**
+ * match the address against the destination record at position j in set
+ * - return -2 if not matching (or only partial match in mixed mode), otherwise
+ *   the result of setting the variables
+ */
+static int ds_is_addr_match_dst(sip_msg_t *_m, struct ip_addr *pipaddr,
+		struct ip_addr *ipa, unsigned short tport, unsigned short tproto,
+		ds_set_t *node, int j, int mode, int export_set_pv)
+{
+	int node_strictness;
+
+	if(ip_addr_cmp(pipaddr, ipa)
+			&& ((mode & DS_MATCH_NOPORT) || node->dlist[j].port == 0
+					|| tport == node->dlist[j].port
+					|| (mode & DS_MATCH_MIXSOCKPRPORT))
+			&& ((mode & DS_MATCH_NOPROTO) || tproto == node->dlist[j].proto
+					|| (mode & DS_MATCH_MIXSOCKPRPORT))
+			&& (((mode & DS_MATCH_ACTIVE) && !ds_skip_dst(node->dlist[j].flags))
+					|| !(mode & DS_MATCH_ACTIVE))
+			&& (((mode & DS_MATCH_SOCKET)
+						&& node->dlist[j].sock == _m->rcv.bind_address)
+					|| !node->dlist[j].sock || !(mode & DS_MATCH_SOCKET))) {
+
+		if(mode & DS_MATCH_MIXSOCKPRPORT) {
+			node_strictness = DS_MATCHED_ADDR;
+			if(node->dlist[j].port) {
+				if(tport == node->dlist[j].port) {
+					node_strictness |= DS_MATCHED_PORT;
+				}
+			}
+
+			if(node->dlist[j].proto) {
+				if(tproto == node->dlist[j].proto) {
+					node_strictness |= DS_MATCHED_PROTO;
+				}
+			}
+
+			if(node->dlist[j].sock) {
+				if(node->dlist[j].sock == _m->rcv.bind_address) {
+					node_strictness |= DS_MATCHED_SOCK;
+				}
+			}
+
+			if(node_strictness
+					== (DS_MATCHED_ADDR | DS_MATCHED_PORT | DS_MATCHED_PROTO
+							| DS_MATCHED_SOCK)) {
+				ds_strictest_match = node_strictness;
+				ds_strictest_node = node;
+				ds_strictest_idx = j;
+				return ds_set_vars(_m, node, j, export_set_pv);
+			}
+
+			if(ds_strictest_match < node_strictness) {
+				ds_strictest_match = node_strictness;
+				ds_strictest_node = node;
+				ds_strictest_idx = j;
+			}
+			return -2;
+		}
+
+		return ds_set_vars(_m, node, j, export_set_pv);
+	}
+	return -2;
+}
+
 int ds_is_addr_from_set(sip_msg_t *_m, struct ip_addr *pipaddr,
 		unsigned short tport, unsigned short tproto, ds_set_t *node, int mode,
 		int export_set_pv)
@@ -4281,7 +4565,7 @@ int ds_is_addr_from_set(sip_msg_t *_m, struct ip_addr *pipaddr,
 	char hn[DS_HN_SIZE];
 	struct hostent *he;
 	int j;
-	int node_strictness;
+	int rc;
 	unsigned short sport = 0;
 	char sproto = PROTO_NONE;
 
@@ -4322,57 +4606,37 @@ int ds_is_addr_from_set(sip_msg_t *_m, struct ip_addr *pipaddr,
 				ipa = &ipaddress;
 			}
 		}
-		if(ip_addr_cmp(pipaddr, ipa)
-				&& ((mode & DS_MATCH_NOPORT) || node->dlist[j].port == 0
-						|| tport == node->dlist[j].port
-						|| (mode & DS_MATCH_MIXSOCKPRPORT))
-				&& ((mode & DS_MATCH_NOPROTO) || tproto == node->dlist[j].proto
-						|| (mode & DS_MATCH_MIXSOCKPRPORT))
-				&& (((mode & DS_MATCH_ACTIVE)
-							&& !ds_skip_dst(node->dlist[j].flags))
-						|| !(mode & DS_MATCH_ACTIVE))
-				&& (((mode & DS_MATCH_SOCKET)
-							&& node->dlist[j].sock == _m->rcv.bind_address)
-						|| !node->dlist[j].sock || !(mode & DS_MATCH_SOCKET))) {
-
-			if(mode & DS_MATCH_MIXSOCKPRPORT) {
-				node_strictness = DS_MATCHED_ADDR;
-				if(node->dlist[j].port) {
-					if(tport == node->dlist[j].port) {
-						node_strictness |= DS_MATCHED_PORT;
-					}
-				}
-
-				if(node->dlist[j].proto) {
-					if(tproto == node->dlist[j].proto) {
-						node_strictness |= DS_MATCHED_PROTO;
-					}
-				}
-
-				if(node->dlist[j].sock) {
-					if(node->dlist[j].sock == _m->rcv.bind_address) {
-						node_strictness |= DS_MATCHED_SOCK;
-					}
-				}
-
-				if(node_strictness
-						== (DS_MATCHED_ADDR | DS_MATCHED_PORT | DS_MATCHED_PROTO
-								| DS_MATCHED_SOCK)) {
-					ds_strictest_match = node_strictness;
-					ds_strictest_node = node;
-					ds_strictest_idx = j;
-					return ds_set_vars(_m, node, j, export_set_pv);
-				}
+		rc = ds_is_addr_match_dst(_m, pipaddr, ipa, tport, tproto, node, j,
+				mode, export_set_pv);
+		if(rc != -2) {
+			return rc;
+		}
+	}
+	return -1;
+}
 
-				if(ds_strictest_match < node_strictness) {
-					ds_strictest_match = node_strictness;
-					ds_strictest_node = node;
-					ds_strictest_idx = j;
-				}
-				continue;
-			}
+/**
+ * match the address using the index of the current list
+ * - node is the set to match against, or NULL for all sets
+ */
+static int ds_is_addr_from_index(sip_msg_t *_m, ds_addr_index_t *dsi,
+		struct ip_addr *pipaddr, unsigned short tport, unsigned short tproto,
+		ds_set_t *node, int mode, int export_set_pv)
+{
+	ds_addr_item_t *it;
+	unsigned int hashid;
+	int rc;
 
-			return ds_set_vars(_m, node, j, export_set_pv);
+	hashid = ds_addr_hashid(pipaddr);
+	for(it = dsi->slots[hashid & (dsi->size - 1)]; it != NULL; it = it->next) {
+		if(it->hashid != hashid || (node != NULL && it->node != node)) {
+			continue;
+		}
+		rc = ds_is_addr_match_dst(_m, pipaddr,
+				&it->node->dlist[it->idx].ip_address, tport, tproto, it->node,
+				it->idx, mode, export_set_pv);
+		if(rc != -2) {
+			return rc;
 		}
 	}
 	return -1;
@@ -4407,6 +4671,7 @@ int ds_is_addr_from_set_r(sip_msg_t *_m, struct ip_addr *pipaddr,
 int ds_is_addr_from_list(sip_msg_t *_m, int group, str *uri, int mode)
 {
 	ds_set_t *list;
+	ds_addr_index_t *dsi;
 
 	struct ip_addr *pipaddr;
 	struct ip_addr aipaddr;
@@ -4464,13 +4729,25 @@ int ds_is_addr_from_list(sip_msg_t *_m, int group, str *uri, int mode)
 		ds_strictest_node = NULL;
 	}
 
+	dsi = ds_addr_lists[*ds_crt_idx];
 	if(group == -1) {
-		rc = ds_is_addr_from_set_r(
-				_m, pipaddr, tport, tproto, _ds_list, mode, 1);
+		if(dsi != NULL) {
+			rc = ds_is_addr_from_index(
+					_m, dsi, pipaddr, tport, tproto, NULL, mode, 1);
+		} else {
+			rc = ds_is_addr_from_set_r(
+					_m, pipaddr, tport, tproto, _ds_list, mode, 1);
+		}
 	} else {
 		list = ds_avl_find(_ds_list, group);
 		if(list) {
-			rc = ds_is_addr_from_set(_m, pipaddr, tport, tproto, list, mode, 0);
+			if(dsi != NULL) {
+				rc = ds_is_addr_from_index(
+						_m, dsi, pipaddr, tport, tproto, list, mode, 0);
+			} else {
+				rc = ds_is_addr_from_set(
+						_m, pipaddr, tport, tproto, list, mode, 0);
+			}
 		}
 	}
 
@@ -4698,9 +4975,11 @@ char *ds_rand_str4(void)
 }
 
 /**
- *
+ * send keepalives to the destinations in the tree of sets
+ * - with ds_ping_spread, only the destinations with the position matching
+ *   the slot (modulo ds_ping_spread) are pinged
  */
-void ds_ping_set(ds_set_t *node)
+static void ds_ping_set_slot(ds_set_t *node, int slot, int *pos)
 {
 	uac_req_t uac_r;
 	int i, j;
@@ -4715,7 +4994,7 @@ void ds_ping_set(ds_set_t *node)
 		return;
 
 	for(i = 0; i < 2; ++i)
-		ds_ping_set(node->next[i]);
+		ds_ping_set_slot(node->next[i], slot, pos);
 
 	for(j = 0; j < node->nr; j++) {
 		/* skip addresses set in disabled state by admin */
@@ -4727,6 +5006,9 @@ void ds_ping_set(ds_set_t *node)
 		/* skip addresses with no-DNS-A flag */
 		if((node->dlist[j].flags & DS_NODNSARES_DST) != 0)
 			continue;
+		/* skip addresses pinged in other slots of the interval */
+		if(ds_ping_spread > 1 && ((*pos)++) % ds_ping_spread != slot)
+			continue;
 		/* If the Flag of the entry has "Probing set, send a probe:	*/
 		if(ds_ping_result_helper(node, j)) {
 			LM_DBG("probing set #%d, URI %.*s\n", node->id,
@@ -4822,14 +5104,32 @@ void ds_ping_set(ds_set_t *node)
 	}
 }
 
+/**
+ * send keepalives to all the destinations in the tree of sets
+ */
+void ds_ping_set(ds_set_t *node)
+{
+	int slot = 0;
+	int pos;
+
+	do {
+		pos = 0;
+		ds_ping_set_slot(node, slot, &pos);
+		slot++;
+	} while(slot < ds_ping_spread);
+}
+
 /*! \brief
  * Timer for checking probing destinations
  *
- * This timer is regularly fired.
+ * This timer is regularly fired, when ds_ping_spread is set, it runs
+ * ds_ping_spread times per ping interval and each time pings only a part
+ * of the destinations.
  */
 void ds_check_timer(unsigned int ticks, void *param)
 {
-
+	static int slot = 0;
+	int pos = 0;
 
 	/* Check for the list. */
 	if(_ds_list == NULL || _ds_list_nr <= 0) {
@@ -4842,7 +5142,12 @@ void ds_check_timer(unsigned int ticks, void *param)
 		return;
 	}
 
-	ds_ping_set(_ds_list);
+	if(ds_ping_spread > 1) {
+		ds_ping_set_slot(_ds_list, slot, &pos);
+		slot = (slot + 1) % ds_ping_spread;
+	} else {
+		ds_ping_set(_ds_list);
+	}
 }
 
 /*! \brief
@@ -103,6 +103,7 @@ int inactive_threshold = 1; /* number of replied requests, before a destination
 str ds_ping_method = str_init("OPTIONS");
 str ds_ping_from   = str_init("sip:dispatcher@localhost");
 static int ds_ping_interval = 0;
+int ds_ping_spread = 0;
 int ds_ping_latency_stats = 0;
 int ds_ping_fr_timeout = 0;
 int ds_retain_latency_stats = 0;
@@ -308,6 +309,7 @@ static param_export_t params[]={
 	{"ds_ping_method",     PARAM_STR, &ds_ping_method},
 	{"ds_ping_from",       PARAM_STR, &ds_ping_from},
 	{"ds_ping_interval",   PARAM_INT, &ds_ping_interval},
+	{"ds_ping_spread",     PARAM_INT, &ds_ping_spread},
 	{"ds_ping_fr_timeout", PARAM_INT, &ds_ping_fr_timeout},
 	{"ds_ping_fr_timer", PARAM_INT, &ds_ping_fr_timeout},
 	{"ds_ping_latency_stats", PARAM_INT, &ds_ping_latency_stats},
@@ -361,6 +363,7 @@ static int mod_init(void)
 	int port, proto;
 	param_hooks_t phooks;
 	param_t *pit = NULL;
+	int ds_ping_tick;
 
 	if(ds_dns_mode & DS_DNS_MODE_TIMER) {
 		if(ds_dns_interval <= 0) {
@@ -397,11 +400,32 @@ static int mod_init(void)
 			LM_ERR("could not load the TM-functions - disable DS ping\n");
 			return -1;
 		}
+		if(ds_ping_spread > ds_ping_interval) {
+			LM_WARN("ping spread %d over ping interval %d - using interval\n",
+					ds_ping_spread, ds_ping_interval);
+			ds_ping_spread = ds_ping_interval;
+		}
+		if(ds_ping_spread > 1) {
+			/* timer fires for each slot of the ping interval - the tick is
+			 * rounded up and the number of slots adjusted to it, so the
+			 * cycle is never shorter than the ping interval */
+			ds_ping_tick = (ds_ping_interval + ds_ping_spread - 1)
+						   / ds_ping_spread;
+			if(ds_ping_interval % ds_ping_spread != 0) {
+				ds_ping_spread =
+						(ds_ping_interval + ds_ping_tick - 1) / ds_ping_tick;
+				LM_WARN("ping interval %d not a multiple of ping spread - "
+						"using %d slots of %d seconds\n",
+						ds_ping_interval, ds_ping_spread, ds_ping_tick);
+			}
+		} else {
+			ds_ping_tick = ds_ping_interval;
+		}
 		if(ds_timer_mode == 1) {
-			if(sr_wtimer_add(ds_check_timer, NULL, ds_ping_interval) < 0)
+			if(sr_wtimer_add(ds_check_timer, NULL, ds_ping_tick) < 0)
 				return -1;
 		} else {
-			if(register_timer(ds_check_timer, NULL, ds_ping_interval) < 0)
+			if(register_timer(ds_check_timer, NULL, ds_ping_tick) < 0)
 				return -1;
 		}
 	}
@@ -31,30 +31,47 @@
 #include "prefix_tree.h"
 #include "routing.h"
 #include "dr_time.h"
+#include "../../core/atomic_ops.h"
 
 extern int inode;
 extern int unode;
 
 
-static inline int check_time(dr_tmrec_t *time_rec)
+static inline int check_time(rt_info_t *rt)
 {
+	dr_tmrec_t *time_rec = rt->time_rec;
 	dr_ac_tm_t att;
+	time_t now;
+	long tmin;
+	long tcache;
+	int ret;
 
 	/* shortcut: if there is no dstart, timerec is valid */
 	if(time_rec->dtstart == 0)
 		return 1;
 
+	now = time(0);
+	tmin = (long)(now / 60);
+	if(rt->time_cacheable) {
+		/* result computed already in the current minute */
+		tcache = atomic_get_long(&rt->time_cache);
+		if((tcache >> 1) == tmin)
+			return (int)(tcache & 1);
+	}
+
 	memset(&att, 0, sizeof(att));
 
 	/* set current time */
-	if(dr_ac_tm_set_time(&att, time(0)))
+	if(dr_ac_tm_set_time(&att, now))
 		return 0;
 
 	/* does the recv_time match the specified interval?  */
-	if(dr_check_tmrec(time_rec, &att, 0) != 0)
-		return 0;
+	ret = (dr_check_tmrec(time_rec, &att, 0) != 0) ? 0 : 1;
+
+	if(rt->time_cacheable)
+		atomic_set_long(&rt->time_cache, (tmin << 1) | ret);
 
-	return 1;
+	return ret;
 }
 
 
@@ -76,7 +93,7 @@ static inline rt_info_t *internal_check_rt(ptree_node_t *ptn, unsigned int rgid)
 		LM_DBG("found rgid %d (rule list %p)\n", rgid, rg[i].rtlw);
 		rtlw = rg[i].rtlw;
 		while(rtlw != NULL) {
-			if(check_time(rtlw->rtl->time_rec))
+			if(check_time(rtlw->rtl))
 				return rtlw->rtl;
 			rtlw = rtlw->next;
 		}
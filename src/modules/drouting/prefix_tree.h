@@ -83,6 +83,10 @@ typedef struct rt_info_
 {
 	unsigned int priority;
 	dr_tmrec_t *time_rec;
+	/* result of the last time check: (minute << 1) | match */
+	long time_cache;
+	/* time_rec changes state only on minute boundaries */
+	int time_cacheable;
 	/* array of pointers into the PSTN gw list */
 	pgw_list_t *pgwl;
 	/* length of the PSTN gw array */
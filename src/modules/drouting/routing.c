@@ -87,6 +87,13 @@ rt_info_t *build_rt_info(int priority, dr_tmrec_t *trec,
 
 	rt->priority = priority;
 	rt->time_rec = trec;
+	/* the time check result can be cached per minute if all the bounds
+	 * of the recurrence are on minute boundaries */
+	if(trec != NULL && trec->dtstart % 60 == 0 && trec->duration % 60 == 0
+			&& (trec->duration != 0 || (trec->dtend - trec->dtstart) % 60 == 0)
+			&& trec->until % 60 == 0) {
+		rt->time_cacheable = 1;
+	}
 	rt->route_idx = route_idx;
 	tmp = dstlst;
 	n = 0;
@@ -34,6 +34,7 @@
 #include "../../core/action.h"
 #include "../../core/route.h"
 #include "../../core/kemi.h"
+#include "../../core/atomic_ops.h"
 
 #include "ht_api.h"
 #include "ht_db.h"
@@ -215,6 +216,84 @@ int ht_cell_free(ht_cell_t *cell)
 	return 0;
 }
 
+/**
+ * release a cell that was unlinked from a slot
+ * - for tables with lock free reads, readers may still walk over the cell,
+ *   it is kept in the retired list and freed after a grace period
+ */
+void ht_cell_release(ht_t *ht, ht_cell_t *cell)
+{
+	if(cell == NULL)
+		return;
+	if(ht->lockfree == 0) {
+		shm_free(cell);
+		return;
+	}
+	/* next is left untouched for readers, prev is used for the list */
+	lock_get(&ht->rlock);
+	cell->prev = ht->retired[0];
+	ht->retired[0] = cell;
+	lock_release(&ht->rlock);
+}
+
+/**
+ * replace a cell in a slot, the slot must be locked
+ * - the new cell is fully built before being published for readers
+ */
+static void ht_cell_replace(ht_t *ht, int idx, ht_cell_t *it, ht_cell_t *cell)
+{
+	cell->next = it->next;
+	cell->prev = it->prev;
+	membar_write();
+	if(it->prev)
+		it->prev->next = cell;
+	else
+		ht->entries[idx].first = cell;
+	if(it->next)
+		it->next->prev = cell;
+	ht_cell_release(ht, it);
+}
+
+/**
+ * lock the slot for reading - no-op for tables with lock free reads
+ */
+#define ht_slot_rlock(ht, idx)        \
+	do {                              \
+		if((ht)->lockfree == 0)       \
+			ht_slot_lock((ht), (idx)); \
+	} while(0)
+
+#define ht_slot_runlock(ht, idx)        \
+	do {                                \
+		if((ht)->lockfree == 0)         \
+			ht_slot_unlock((ht), (idx)); \
+	} while(0)
+
+/**
+ * copy a cell to pkg buffer old if it is large enough, otherwise to a new
+ * pkg buffer
+ */
+static ht_cell_t *ht_cell_pkg_clone(ht_t *ht, ht_cell_t *it, ht_cell_t *old)
+{
+	ht_cell_t *cell;
+
+	if(old != NULL && old->msize >= it->msize) {
+		cell = old;
+	} else {
+		cell = (ht_cell_t *)pkg_malloc(it->msize);
+		if(cell == NULL) {
+			PKG_MEM_ERROR;
+			return NULL;
+		}
+	}
+	memcpy(cell, it, it->msize);
+	cell->name.s = (char *)cell + sizeof(ht_cell_t);
+	if(cell->flags & AVP_VAL_STR) {
+		cell->value.s.s = (char *)cell->name.s + cell->name.len + 1;
+	}
+	return cell;
+}
+
 int ht_cell_pkg_free(ht_cell_t *cell)
 {
 	if(cell == NULL)
@@ -255,7 +334,8 @@ ht_t *ht_get_table(str *name)
 
 int ht_add_table(str *name, int autoexp, str *dbtable, str *dbcols, int size,
 		int dbmode, int itype, int_str *ival, int updateexpire,
-		int dmqreplicate, char coldelim, char colnull, int reloadat)
+		int dmqreplicate, char coldelim, char colnull, int reloadat,
+		int snapshot, int lockfree)
 {
 	unsigned int htid;
 	ht_t *ht;
@@ -305,6 +385,8 @@ int ht_add_table(str *name, int autoexp, str *dbtable, str *dbcols, int size,
 	ht->dmqreplicate = dmqreplicate;
 	ht->reloadat = reloadat;
 	ht->last_reload = 0;
+	ht->snapshot = snapshot;
+	ht->lockfree = lockfree;
 
 	if(dbcols != NULL && dbcols->s != NULL && dbcols->len > 0) {
 		ht->scols[0].s = (char *)shm_malloc((1 + dbcols->len) * sizeof(char));
@@ -425,6 +507,14 @@ int ht_init_tables(void)
 		}
 		memset(ht->entries, 0, ht->htsize * sizeof(ht_entry_t));
 
+		if(ht->lockfree && lock_init(&ht->rlock) == 0) {
+			LM_ERR("cannot initialize retired lock in [%.*s]\n", ht->name.len,
+					ht->name.s);
+			shm_free(ht->entries);
+			ht->entries = NULL;
+			return -1;
+		}
+
 		for(i = 0; i < ht->htsize; i++) {
 			if(lock_init(&ht->entries[i].lock) == 0) {
 				LM_ERR("cannot initialize lock[%d] in [%.*s]\n", i,
@@ -472,6 +562,13 @@ int ht_destroy(void)
 			}
 			shm_free(ht->entries);
 		}
+		for(i = 0; i < 2; i++) {
+			while(ht->retired[i]) {
+				it = ht->retired[i];
+				ht->retired[i] = it->prev;
+				ht_cell_free(it);
+			}
+		}
 		shm_free(ht);
 		ht = ht0;
 	}
@@ -507,6 +604,10 @@ int ht_set_cell_ex(
 	prev = NULL;
 	if(mode)
 		ht_slot_lock(ht, idx);
+	if(now > 0) {
+		/* the item will not expire earlier than this value */
+		HT_SLOT_EXPIRE_HINT(ht, idx, now + ((exv > 0) ? exv : ht->htexpire));
+	}
 	it = ht->entries[idx].first;
 	while(it != NULL && it->cellid < hid) {
 		prev = it;
@@ -515,6 +616,25 @@ int ht_set_cell_ex(
 	while(it != NULL && it->cellid == hid) {
 		if(name->len == it->name.len
 				&& strncmp(name->s, it->name.s, name->len) == 0) {
+			if(ht->lockfree) {
+				/* published cells are not changed - replace */
+				cell = ht_cell_new(name, type, val, hid);
+				if(cell == NULL) {
+					LM_ERR("cannot create new cell\n");
+					if(mode)
+						ht_slot_unlock(ht, idx);
+					return -1;
+				}
+				if(exv <= 0) {
+					HT_COPY_EXPIRE(ht, cell, now, it);
+				} else {
+					cell->expire = now + exv;
+				}
+				ht_cell_replace(ht, idx, it, cell);
+				if(mode)
+					ht_slot_unlock(ht, idx);
+				return 0;
+			}
 			/* update value */
 			if(it->flags & AVP_VAL_STR) {
 				if(type & AVP_VAL_STR) {
@@ -543,7 +663,7 @@ int ht_set_cell_ex(
 						if(exv <= 0) {
 							HT_COPY_EXPIRE(ht, cell, now, it);
 						} else {
-							it->expire = now + exv;
+							cell->expire = now + exv;
 						}
 						if(it->prev)
 							it->prev->next = cell;
@@ -551,7 +671,7 @@ int ht_set_cell_ex(
 							ht->entries[idx].first = cell;
 						if(it->next)
 							it->next->prev = cell;
-						ht_cell_free(it);
+						ht_cell_release(ht, it);
 					}
 				} else {
 					it->flags &= ~AVP_VAL_STR;
@@ -579,7 +699,7 @@ int ht_set_cell_ex(
 					if(exv <= 0) {
 						HT_COPY_EXPIRE(ht, cell, now, it);
 					} else {
-						it->expire = now + exv;
+						cell->expire = now + exv;
 					}
 
 					cell->next = it->next;
@@ -590,7 +710,7 @@ int ht_set_cell_ex(
 						ht->entries[idx].first = cell;
 					if(it->next)
 						it->next->prev = cell;
-					ht_cell_free(it);
+					ht_cell_release(ht, it);
 				} else {
 					it->value.n = val->n;
 
@@ -626,12 +746,14 @@ int ht_set_cell_ex(
 			cell->next = ht->entries[idx].first;
 			ht->entries[idx].first->prev = cell;
 		}
+		membar_write();
 		ht->entries[idx].first = cell;
 	} else {
 		cell->next = prev->next;
 		cell->prev = prev;
 		if(prev->next)
 			prev->next->prev = cell;
+		membar_write();
 		prev->next = cell;
 	}
 	ht->entries[idx].esize++;
@@ -713,7 +835,7 @@ int ht_del_cell_confirm(ht_t *ht, str *name)
 			/* found */
 			ht_cell_unlink(ht, idx, it);
 			ht_slot_unlock(ht, idx);
-			ht_cell_free(it);
+			ht_cell_release(ht, it);
 			return 1;
 		}
 		it = it->next;
@@ -744,8 +866,12 @@ ht_cell_t *ht_cell_value_add(ht_t *ht, str *name, int val, ht_cell_t *old)
 	now = 0;
 	if(ht->htexpire > 0)
 		now = time(NULL);
+
 	prev = NULL;
 	ht_slot_lock(ht, idx);
+	if(now > 0) {
+		HT_SLOT_EXPIRE_HINT(ht, idx, now + ht->htexpire);
+	}
 	it = ht->entries[idx].first;
 	while(it != NULL && it->cellid < hid) {
 		prev = it;
@@ -755,6 +881,46 @@ ht_cell_t *ht_cell_value_add(ht_t *ht, str *name, int val, ht_cell_t *old)
 		if(name->len == it->name.len
 				&& strncmp(name->s, it->name.s, name->len) == 0) {
 			/* found */
+			if(ht->lockfree) {
+				if(now > 0 && it->expire != 0 && it->expire < now) {
+					/* entry has expired - replace it */
+					if(ht->flags != PV_VAL_INT) {
+						ht_slot_unlock(ht, idx);
+						return NULL;
+					}
+					isval.n = ht->initval.n + val;
+					cell = ht_cell_new(name, 0, &isval, hid);
+					if(cell == NULL) {
+						LM_ERR("cannot create new cell.\n");
+						ht_slot_unlock(ht, idx);
+						return NULL;
+					}
+					cell->expire = now + ht->htexpire;
+					ht_cell_replace(ht, idx, it, cell);
+					it = cell;
+					goto done;
+				}
+				if(it->flags & AVP_VAL_STR) {
+					/* string value cannot be incremented */
+					ht_slot_unlock(ht, idx);
+					return NULL;
+				}
+				/* published cells are not changed - replace */
+				isval.n = it->value.n + val;
+				cell = ht_cell_new(name, 0, &isval, hid);
+				if(cell == NULL) {
+					LM_ERR("cannot create new cell.\n");
+					ht_slot_unlock(ht, idx);
+					return NULL;
+				}
+				if(ht->updateexpire)
+					cell->expire = now + ht->htexpire;
+				else
+					cell->expire = it->expire;
+				ht_cell_replace(ht, idx, it, cell);
+				it = cell;
+				goto done;
+			}
 			if(now > 0 && it->expire != 0 && it->expire < now) {
 				/* entry has expired */
 
@@ -817,15 +983,18 @@ ht_cell_t *ht_cell_value_add(ht_t *ht, str *name, int val, ht_cell_t *old)
 			it->next = ht->entries[idx].first;
 			ht->entries[idx].first->prev = it;
 		}
+		membar_write();
 		ht->entries[idx].first = it;
 	} else {
 		it->next = prev->next;
 		it->prev = prev;
 		if(prev->next)
 			prev->next->prev = it;
+		membar_write();
 		prev->next = it;
 	}
 	ht->entries[idx].esize++;
+done:
 	if(old != NULL) {
 		if(old->msize >= it->msize) {
 			memcpy(old, it, it->msize);
@@ -863,7 +1032,7 @@ ht_cell_t *ht_cell_pkg_copy(ht_t *ht, str *name, ht_cell_t *old)
 	if(ht->entries[idx].first == NULL)
 		return NULL;
 
-	ht_slot_lock(ht, idx);
+	ht_slot_rlock(ht, idx);
 	it = ht->entries[idx].first;
 	while(it != NULL && it->cellid < hid)
 		it = it->next;
@@ -873,31 +1042,16 @@ ht_cell_t *ht_cell_pkg_copy(ht_t *ht, str *name, ht_cell_t *old)
 			/* found */
 			if(ht->htexpire > 0 && it->expire != 0 && it->expire < time(NULL)) {
 				/* entry has expired, return NULL */
-				ht_slot_unlock(ht, idx);
+				ht_slot_runlock(ht, idx);
 				return NULL;
 			}
-			if(old != NULL) {
-				if(old->msize >= it->msize) {
-					memcpy(old, it, it->msize);
-					ht_slot_unlock(ht, idx);
-					return old;
-				}
-			}
-			cell = (ht_cell_t *)pkg_malloc(it->msize);
-			if(cell != NULL) {
-				memcpy(cell, it, it->msize);
-
-				cell->name.s = (char *)cell + sizeof(ht_cell_t);
-				if(cell->flags & AVP_VAL_STR) {
-					cell->value.s.s = (char *)cell->name.s + cell->name.len + 1;
-				}
-			}
-			ht_slot_unlock(ht, idx);
+			cell = ht_cell_pkg_clone(ht, it, old);
+			ht_slot_runlock(ht, idx);
 			return cell;
 		}
 		it = it->next;
 	}
-	ht_slot_unlock(ht, idx);
+	ht_slot_runlock(ht, idx);
 	return NULL;
 }
 
@@ -922,7 +1076,7 @@ int ht_cell_exists(ht_t *ht, str *name)
 	if(ht->entries[idx].first == NULL)
 		return 0;
 
-	ht_slot_lock(ht, idx);
+	ht_slot_rlock(ht, idx);
 	it = ht->entries[idx].first;
 	while(it != NULL && it->cellid < hid)
 		it = it->next;
@@ -932,15 +1086,15 @@ int ht_cell_exists(ht_t *ht, str *name)
 			/* found */
 			if(ht->htexpire > 0 && it->expire != 0 && it->expire < time(NULL)) {
 				/* entry has expired */
-				ht_slot_unlock(ht, idx);
+				ht_slot_runlock(ht, idx);
 				return 0;
 			}
-			ht_slot_unlock(ht, idx);
+			ht_slot_runlock(ht, idx);
 			return 1;
 		}
 		it = it->next;
 	}
-	ht_slot_unlock(ht, idx);
+	ht_slot_runlock(ht, idx);
 	return 0;
 }
 
@@ -989,6 +1143,8 @@ int ht_table_spec(char *spec)
 	unsigned int updateexpire = 1;
 	unsigned int dmqreplicate = 0;
 	unsigned int reloadat = 0;
+	unsigned int snapshot = 0;
+	unsigned int lockfree = 0;
 	char coldelim = ',';
 	char colnull = '*';
 	str in;
@@ -1083,6 +1239,18 @@ int ht_table_spec(char *spec)
 				goto error;
 			LM_DBG("htable [%.*s] - reloadat [%u]\n", name.len, name.s,
 					reloadat);
+		} else if(pit->name.len == 8
+				  && strncmp(pit->name.s, "snapshot", 8) == 0) {
+			if(str2int(&tok, &snapshot) != 0)
+				goto error;
+			LM_DBG("htable [%.*s] - snapshot [%u]\n", name.len, name.s,
+					snapshot);
+		} else if(pit->name.len == 8
+				  && strncmp(pit->name.s, "lockfree", 8) == 0) {
+			if(str2int(&tok, &lockfree) != 0)
+				goto error;
+			LM_DBG("htable [%.*s] - lockfree [%u]\n", name.len, name.s,
+					lockfree);
 		} else {
 			goto error;
 		}
@@ -1090,7 +1258,7 @@ int ht_table_spec(char *spec)
 
 	return ht_add_table(&name, autoexpire, &dbtable, &dbcols, size, dbmode,
 			itype, &ival, updateexpire, dmqreplicate, coldelim, colnull,
-			reloadat);
+			reloadat, snapshot, lockfree);
 
 error:
 	LM_ERR("invalid htable parameter [%.*s]\n", in.len, in.s);
@@ -1103,7 +1271,11 @@ int ht_db_load_tables(void)
 
 	ht = _ht_root;
 	while(ht) {
-		if(ht->dbtable.len > 0) {
+		if(ht->dbtable.len > 0 && ht->snaptime > 0) {
+			LM_INFO("htable [%.*s] restored from snapshot - skip loading db "
+					"table [%.*s]\n",
+					ht->name.len, ht->name.s, ht->dbtable.len, ht->dbtable.s);
+		} else if(ht->dbtable.len > 0) {
 			LM_DBG("loading db table [%.*s] in ht [%.*s]\n", ht->dbtable.len,
 					ht->dbtable.s, ht->name.len, ht->name.s);
 			if(ht_db_load_table(ht, &ht->dbtable, 0) != 0)
@@ -1150,6 +1322,46 @@ int ht_has_autoexpire(void)
 	return 0;
 }
 
+int ht_has_lockfree(void)
+{
+	ht_t *ht;
+
+	for(ht = _ht_root; ht != NULL; ht = ht->next) {
+		if(ht->lockfree)
+			return 1;
+	}
+	return 0;
+}
+
+/**
+ * free the cells retired during the previous grace period
+ * - a retired cell is freed after one to two timer intervals, enough
+ *   for any reader that got its address before it was unlinked
+ */
+void ht_lockfree_timer(unsigned int ticks, void *param)
+{
+	ht_t *ht;
+	ht_cell_t *it;
+	ht_cell_t *it0;
+
+	for(ht = _ht_root; ht != NULL; ht = ht->next) {
+		if(ht->lockfree == 0)
+			continue;
+		if(ht->retired[0] == NULL && ht->retired[1] == NULL)
+			continue;
+		lock_get(&ht->rlock);
+		it = ht->retired[1];
+		ht->retired[1] = ht->retired[0];
+		ht->retired[0] = NULL;
+		lock_release(&ht->rlock);
+		while(it) {
+			it0 = it->prev;
+			ht_cell_free(it);
+			it = it0;
+		}
+	}
+}
+
 extern int ht_timer_procs;
 
 void ht_timer(unsigned int ticks, void *param)
@@ -1177,8 +1389,14 @@ void ht_timer(unsigned int ticks, void *param)
 	while(ht) {
 		if(ht->htexpire > 0) {
 			for(i = istart; i < ht->htsize; i += istep) {
+				/* no item to expire yet - skip without locking */
+				if(ht->entries[i].next_expire > now)
+					continue;
 				/* free entries */
 				ht_slot_lock(ht, i);
+				/* lowered by the remaining items and by updates done
+				 * in the event route for expired items */
+				ht->entries[i].next_expire = HT_EXPIRE_NEVER;
 				it = ht->entries[i].first;
 				while(it) {
 					it0 = it->next;
@@ -1193,9 +1411,12 @@ void ht_timer(unsigned int ticks, void *param)
 							if(it->next)
 								it->next->prev = it->prev;
 							ht->entries[i].esize--;
-							ht_cell_free(it);
+							ht_cell_release(ht, it);
+							it = it0;
+							continue;
 						}
 					}
+					HT_SLOT_EXPIRE_HINT(ht, i, it->expire);
 					it = it0;
 				}
 				ht_slot_unlock(ht, i);
@@ -1357,6 +1578,7 @@ int ht_set_cell_expire(ht_t *ht, str *name, int type, int_str *val)
 	LM_DBG("set auto-expire to %llu (%ld)\n", (unsigned long long)now, val->n);
 
 	ht_slot_lock(ht, idx);
+	HT_SLOT_EXPIRE_HINT(ht, idx, now);
 	it = ht->entries[idx].first;
 	while(it != NULL && it->cellid < hid)
 		it = it->next;
@@ -1398,7 +1620,7 @@ int ht_get_cell_expire(ht_t *ht, str *name, unsigned int *val)
 	idx = ht_get_entry(hid, ht->htsize);
 
 	now = time(NULL);
-	ht_slot_lock(ht, idx);
+	ht_slot_rlock(ht, idx);
 	it = ht->entries[idx].first;
 	while(it != NULL && it->cellid < hid)
 		it = it->next;
@@ -1407,12 +1629,12 @@ int ht_get_cell_expire(ht_t *ht, str *name, unsigned int *val)
 				&& strncmp(name->s, it->name.s, name->len) == 0) {
 			/* update value */
 			*val = (unsigned int)(it->expire - now);
-			ht_slot_unlock(ht, idx);
+			ht_slot_runlock(ht, idx);
 			return 0;
 		}
 		it = it->next;
 	}
-	ht_slot_unlock(ht, idx);
+	ht_slot_runlock(ht, idx);
 	return 0;
 }
 
@@ -1456,7 +1678,7 @@ int ht_rm_cell_re(str *sre, ht_t *ht, int mode)
 				if(it->next)
 					it->next->prev = it->prev;
 				ht->entries[i].esize--;
-				ht_cell_free(it);
+				ht_cell_release(ht, it);
 			}
 			it = it0;
 		}
@@ -1538,7 +1760,7 @@ int ht_rm_cell_op(str *sre, ht_t *ht, int mode, int op)
 				if(it->next)
 					it->next->prev = it->prev;
 				ht->entries[i].esize--;
-				ht_cell_free(it);
+				ht_cell_release(ht, it);
 			}
 			it = it0;
 		}
@@ -1652,7 +1874,7 @@ int ht_reset_content(ht_t *ht)
 			if(it->next)
 				it->next->prev = it->prev;
 			ht->entries[i].esize--;
-			ht_cell_free(it);
+			ht_cell_release(ht, it);
 			it = it0;
 		}
 		ht_slot_unlock(ht, i);
@@ -1975,7 +2197,7 @@ int ht_iterator_rm(str *iname)
 	_ht_iterators[k].it = _ht_iterators[k].it->next;
 
 	ht_cell_unlink(_ht_iterators[k].ht, _ht_iterators[k].slot, itb);
-	ht_cell_free(itb);
+	ht_cell_release(_ht_iterators[k].ht, itb);
 
 	if(_ht_iterators[k].it != NULL) {
 		/* next item is in the same slot */
@@ -2023,7 +2245,7 @@ int ht_iterator_sets(str *iname, str *sval)
 	itb = _ht_iterators[k].it;
 
 	/* update value */
-	if(itb->flags & AVP_VAL_STR) {
+	if((itb->flags & AVP_VAL_STR) && _ht_iterators[k].ht->lockfree == 0) {
 		if(itb->value.s.len >= sval->len) {
 			/* copy */
 			itb->value.s.len = sval->len;
@@ -2032,6 +2254,8 @@ int ht_iterator_sets(str *iname, str *sval)
 
 			if(_ht_iterators[k].ht->updateexpire) {
 				itb->expire = time(NULL) + _ht_iterators[k].ht->htexpire;
+				HT_SLOT_EXPIRE_HINT(_ht_iterators[k].ht, _ht_iterators[k].slot,
+						itb->expire);
 			}
 			return 0;
 		}
@@ -2046,20 +2270,14 @@ int ht_iterator_sets(str *iname, str *sval)
 		LM_ERR("cannot create new cell\n");
 		return -1;
 	}
-	cell->next = itb->next;
-	cell->prev = itb->prev;
 	if(_ht_iterators[k].ht->updateexpire) {
 		cell->expire = time(NULL) + _ht_iterators[k].ht->htexpire;
+		HT_SLOT_EXPIRE_HINT(
+				_ht_iterators[k].ht, _ht_iterators[k].slot, cell->expire);
 	} else {
 		cell->expire = itb->expire;
 	}
-	if(itb->prev)
-		itb->prev->next = cell;
-	else
-		_ht_iterators[k].ht->entries[_ht_iterators[k].slot].first = cell;
-	if(itb->next)
-		itb->next->prev = cell;
-	ht_cell_free(itb);
+	ht_cell_replace(_ht_iterators[k].ht, _ht_iterators[k].slot, itb, cell);
 	_ht_iterators[k].it = cell;
 
 	return 0;
@@ -2069,6 +2287,8 @@ int ht_iterator_seti(str *iname, int ival)
 {
 	int k;
 	ht_cell_t *itb;
+	ht_cell_t *cell;
+	int_str isvalue;
 
 	k = ht_iterator_find(iname);
 	if(k == -1) {
@@ -2086,6 +2306,26 @@ int ht_iterator_seti(str *iname, int ival)
 
 	itb = _ht_iterators[k].it;
 
+	if(_ht_iterators[k].ht->lockfree) {
+		/* published cells are not changed - replace */
+		isvalue.n = ival;
+		cell = ht_cell_new(&itb->name, 0, &isvalue, itb->cellid);
+		if(cell == NULL) {
+			LM_ERR("cannot create new cell\n");
+			return -1;
+		}
+		if(_ht_iterators[k].ht->updateexpire) {
+			cell->expire = time(NULL) + _ht_iterators[k].ht->htexpire;
+			HT_SLOT_EXPIRE_HINT(
+					_ht_iterators[k].ht, _ht_iterators[k].slot, cell->expire);
+		} else {
+			cell->expire = itb->expire;
+		}
+		ht_cell_replace(_ht_iterators[k].ht, _ht_iterators[k].slot, itb, cell);
+		_ht_iterators[k].it = cell;
+		return 0;
+	}
+
 	/* update value */
 	if(itb->flags & AVP_VAL_STR) {
 		itb->flags &= ~AVP_VAL_STR;
@@ -2094,6 +2334,8 @@ int ht_iterator_seti(str *iname, int ival)
 
 	if(_ht_iterators[k].ht->updateexpire) {
 		itb->expire = time(NULL) + _ht_iterators[k].ht->htexpire;
+		HT_SLOT_EXPIRE_HINT(
+				_ht_iterators[k].ht, _ht_iterators[k].slot, itb->expire);
 	}
 	return 0;
 }
@@ -2121,6 +2363,7 @@ int ht_iterator_setex(str *iname, int exval)
 
 	/* update expire */
 	itb->expire = time(NULL) + exval;
+	HT_SLOT_EXPIRE_HINT(_ht_iterators[k].ht, _ht_iterators[k].slot, itb->expire);
 
 	return 0;
 }
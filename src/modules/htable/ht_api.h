@@ -23,6 +23,7 @@
 #define _HT_API_H_
 
 #include <time.h>
+#include <limits.h>
 
 #include "../../core/usr_avp.h"
 #include "../../core/locking.h"
@@ -51,8 +52,11 @@ typedef struct _ht_entry
 	gen_lock_t lock;	 /* mutex to access items in the slot */
 	atomic_t locker_pid; /* pid of the process that holds the lock */
 	int rec_lock_level;	 /* recursive lock count */
+	time_t next_expire;	 /* not later than the earliest item expiration */
 } ht_entry_t;
 
+#define HT_EXPIRE_NEVER ((time_t)LONG_MAX)
+
 #define HT_MAX_COLS 8
 #define HT_EVEX_NAME_SIZE 64
 
@@ -77,6 +81,11 @@ typedef struct _ht
 	str evex_name;
 	unsigned int reloadat;
 	time_t last_reload;
+	int snapshot;
+	time_t snaptime;
+	int lockfree;		   /* reads without slot lock, immutable cells */
+	gen_lock_t rlock;	   /* lock for the list of retired cells */
+	ht_cell_t *retired[2]; /* cells unlinked in current and previous grace */
 	int evex_reload_index;
 	char evex_reload_name_buf[HT_EVEX_NAME_SIZE];
 	str evex_reload_name;
@@ -93,7 +102,8 @@ typedef struct _ht_pv
 
 int ht_add_table(str *name, int autoexp, str *dbtable, str *dbcols, int size,
 		int dbmode, int itype, int_str *ival, int updateexpire,
-		int dmqreplicate, char coldelim, char colnull, int reloadat);
+		int dmqreplicate, char coldelim, char colnull, int reloadat,
+		int snapshot, int lockfree);
 int ht_init_tables(void);
 int ht_destroy(void);
 int ht_set_cell(ht_t *ht, str *name, int type, int_str *val, int mode);
@@ -106,6 +116,7 @@ int ht_dbg(void);
 ht_cell_t *ht_cell_pkg_copy(ht_t *ht, str *name, ht_cell_t *old);
 int ht_cell_pkg_free(ht_cell_t *cell);
 int ht_cell_free(ht_cell_t *cell);
+void ht_cell_release(ht_t *ht, ht_cell_t *cell);
 
 int ht_table_spec(char *spec);
 ht_t *ht_get_table(str *name);
@@ -115,6 +126,8 @@ int ht_db_sync_tables(void);
 int ht_has_autoexpire(void);
 void ht_timer(unsigned int ticks, void *param);
 void ht_handle_expired_record(ht_t *ht, ht_cell_t *cell);
+int ht_has_lockfree(void);
+void ht_lockfree_timer(unsigned int ticks, void *param);
 int ht_reload_table(ht_t *ht);
 void ht_handle_reloaded_table(ht_t *ht);
 int ht_set_cell_expire(ht_t *ht, str *name, int type, int_str *val);
@@ -151,6 +164,14 @@ ht_cell_t *ht_iterator_get_current(str *iname);
 void ht_slot_lock(ht_t *ht, int idx);
 void ht_slot_unlock(ht_t *ht, int idx);
 
+/* keep next_expire of the slot lower or equal to a new expire value */
+#define HT_SLOT_EXPIRE_HINT(ht, idx, exp)                                 \
+	do {                                                                  \
+		if((exp) > 0 && (exp) < (ht)->entries[idx].next_expire) {         \
+			(ht)->entries[idx].next_expire = (exp);                       \
+		}                                                                 \
+	} while(0)
+
 #define HT_UPDATE_EXPIRE(ht, it, now)                                     \
 	do {                                                                  \
 		if(ht->updateexpire || (now && it->expire && it->expire < now)) { \
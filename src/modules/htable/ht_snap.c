@@ -0,0 +1,451 @@
+/**
+ * Copyright (C) 2026 kamailio.org
+ *
+ * This file is part of Kamailio, a free SIP server.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Kamailio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version
+ *
+ * Kamailio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*!
+ * \file
+ * \brief Binary snapshot of hash table content
+ *
+ * Snapshot file layout (host byte order, all blocks 8-byte aligned):
+ *   - ht_snap_hdr_t, followed by the table name
+ *   - nitems x (ht_snap_rec_t, key bytes, string value bytes)
+ * The file is written to a temporary name and renamed in place, so a
+ * reader sees either the previous or the new complete snapshot.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "../../core/dprint.h"
+#include "../../core/usr_avp.h"
+#include "../../core/mem/mem.h"
+
+#include "ht_snap.h"
+
+str ht_snapshot_dir = STR_NULL;
+int ht_snapshot_interval = 0;
+int ht_snapshot_max_age = 3600;
+
+typedef struct ht_snap_hdr
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t hdrsize;
+	uint32_t namelen;
+	int64_t stime;
+	uint64_t nitems;
+} ht_snap_hdr_t;
+
+typedef struct ht_snap_rec
+{
+	uint32_t flags;
+	uint32_t klen;
+	uint32_t vlen;
+	uint32_t reserved;
+	int64_t expire;
+	int64_t ival;
+} ht_snap_rec_t;
+
+#define HT_SNAP_ALIGN(_n) (((_n) + 7) & ~((size_t)7))
+
+static char _ht_snap_pad[8] = {0};
+
+/**
+ *
+ */
+int ht_snap_enabled(void)
+{
+	return (ht_snapshot_dir.s != NULL && ht_snapshot_dir.len > 0) ? 1 : 0;
+}
+
+/**
+ * build the path of the snapshot file for a table into pkg memory
+ * - tmp: if set, the path of the temporary file used while writing, unique
+ *   per process, so that snapshots written at the same time from timer,
+ *   rpc or shutdown do not share it
+ */
+static char *ht_snap_path(ht_t *ht, int tmp)
+{
+	char *path;
+	int len;
+
+	/* '.' + pid (max 10 digits) + ".tmp" */
+	len = ht_snapshot_dir.len + 1 + ht->name.len + sizeof(HT_SNAP_SUFFIX)
+		  + ((tmp) ? 15 : 0);
+	path = (char *)pkg_malloc(len + 1);
+	if(path == NULL) {
+		PKG_MEM_ERROR;
+		return NULL;
+	}
+	if(tmp) {
+		snprintf(path, len + 1, "%.*s/%.*s%s.%d.tmp", ht_snapshot_dir.len,
+				ht_snapshot_dir.s, ht->name.len, ht->name.s, HT_SNAP_SUFFIX,
+				(int)getpid());
+	} else {
+		snprintf(path, len + 1, "%.*s/%.*s%s", ht_snapshot_dir.len,
+				ht_snapshot_dir.s, ht->name.len, ht->name.s, HT_SNAP_SUFFIX);
+	}
+	return path;
+}
+
+/**
+ * serialize the items of a slot into the pkg buffer *sbuf, growing it
+ * as needed - must be called with the slot locked
+ * - return: the number of bytes used in *sbuf, -1 on error
+ */
+static long ht_snap_copy_slot(ht_t *ht, int idx, time_t now, char **sbuf,
+		size_t *ssize, uint64_t *nitems)
+{
+	ht_snap_rec_t *rec;
+	ht_cell_t *it;
+	size_t need = 0;
+	char *p;
+
+	for(it = ht->entries[idx].first; it != NULL; it = it->next) {
+		if(ht->htexpire > 0 && it->expire != 0 && it->expire < now)
+			continue;
+		need += sizeof(ht_snap_rec_t)
+				+ HT_SNAP_ALIGN(it->name.len
+								+ ((it->flags & AVP_VAL_STR) ? it->value.s.len
+															 : 0));
+	}
+	if(need == 0)
+		return 0;
+	if(need > *ssize) {
+		p = (char *)pkg_realloc(*sbuf, need);
+		if(p == NULL) {
+			PKG_MEM_ERROR;
+			return -1;
+		}
+		*sbuf = p;
+		*ssize = need;
+	}
+
+	p = *sbuf;
+	memset(p, 0, need);
+	for(it = ht->entries[idx].first; it != NULL; it = it->next) {
+		if(ht->htexpire > 0 && it->expire != 0 && it->expire < now)
+			continue;
+		rec = (ht_snap_rec_t *)p;
+		rec->flags = (it->flags & AVP_VAL_STR) ? AVP_VAL_STR : 0;
+		rec->klen = it->name.len;
+		rec->expire = (int64_t)it->expire;
+		if(rec->flags & AVP_VAL_STR) {
+			rec->vlen = it->value.s.len;
+		} else {
+			rec->ival = (int64_t)it->value.n;
+		}
+		p += sizeof(ht_snap_rec_t);
+		memcpy(p, it->name.s, rec->klen);
+		if(rec->vlen > 0)
+			memcpy(p + rec->klen, it->value.s.s, rec->vlen);
+		p += HT_SNAP_ALIGN(rec->klen + rec->vlen);
+		(*nitems)++;
+	}
+	return (long)need;
+}
+
+/**
+ * write the content of the hash table to its snapshot file
+ * - each slot is locked only while its items are copied to a private
+ *   buffer, the file is written after the slot is unlocked
+ */
+int ht_snap_save_table(ht_t *ht)
+{
+	ht_snap_hdr_t hdr;
+	char *tpath = NULL;
+	char *fpath = NULL;
+	char *sbuf = NULL;
+	size_t ssize = 0;
+	FILE *fp = NULL;
+	time_t now;
+	uint64_t nitems = 0;
+	size_t len;
+	long slen;
+	int i;
+
+	if(!ht_snap_enabled() || ht == NULL || ht->entries == NULL)
+		return -1;
+
+	tpath = ht_snap_path(ht, 1);
+	fpath = ht_snap_path(ht, 0);
+	if(tpath == NULL || fpath == NULL)
+		goto error;
+
+	fp = fopen(tpath, "w");
+	if(fp == NULL) {
+		LM_ERR("cannot open snapshot file [%s] for htable [%.*s]\n", tpath,
+				ht->name.len, ht->name.s);
+		goto error;
+	}
+
+	now = time(NULL);
+	memset(&hdr, 0, sizeof(ht_snap_hdr_t));
+	memcpy(hdr.magic, HT_SNAP_MAGIC, 4);
+	hdr.version = HT_SNAP_VERSION;
+	hdr.hdrsize = sizeof(ht_snap_hdr_t);
+	hdr.namelen = ht->name.len;
+	hdr.stime = (int64_t)now;
+	/* nitems updated at the end */
+	if(fwrite(&hdr, sizeof(ht_snap_hdr_t), 1, fp) != 1
+			|| fwrite(ht->name.s, 1, ht->name.len, fp) != ht->name.len)
+		goto error_write;
+	len = HT_SNAP_ALIGN(ht->name.len) - ht->name.len;
+	if(len > 0 && fwrite(_ht_snap_pad, 1, len, fp) != len)
+		goto error_write;
+
+	for(i = 0; i < ht->htsize; i++) {
+		if(ht->entries[i].first == NULL)
+			continue;
+		ht_slot_lock(ht, i);
+		slen = ht_snap_copy_slot(ht, i, now, &sbuf, &ssize, &nitems);
+		ht_slot_unlock(ht, i);
+		if(slen < 0)
+			goto error;
+		if(slen > 0 && fwrite(sbuf, 1, (size_t)slen, fp) != (size_t)slen)
+			goto error_write;
+	}
+
+	hdr.nitems = nitems;
+	if(fseek(fp, 0, SEEK_SET) != 0
+			|| fwrite(&hdr, sizeof(ht_snap_hdr_t), 1, fp) != 1)
+		goto error_write;
+	if(fflush(fp) != 0 || fsync(fileno(fp)) != 0)
+		goto error_write;
+	fclose(fp);
+	fp = NULL;
+
+	if(rename(tpath, fpath) != 0) {
+		LM_ERR("cannot rename snapshot file [%s] to [%s]\n", tpath, fpath);
+		unlink(tpath);
+		goto error;
+	}
+	LM_DBG("htable [%.*s] - saved %llu items in snapshot [%s]\n", ht->name.len,
+			ht->name.s, (unsigned long long)nitems, fpath);
+	if(sbuf != NULL)
+		pkg_free(sbuf);
+	pkg_free(tpath);
+	pkg_free(fpath);
+	return 0;
+
+error_write:
+	LM_ERR("failed to write snapshot file [%s] for htable [%.*s]\n", tpath,
+			ht->name.len, ht->name.s);
+	fclose(fp);
+	fp = NULL;
+	unlink(tpath);
+error:
+	if(fp != NULL) {
+		fclose(fp);
+		unlink(tpath);
+	}
+	if(sbuf != NULL)
+		pkg_free(sbuf);
+	if(tpath != NULL)
+		pkg_free(tpath);
+	if(fpath != NULL)
+		pkg_free(fpath);
+	return -1;
+}
+
+/**
+ * load the hash table content from its snapshot file
+ * - return: number of loaded items, -1 if the snapshot is missing or invalid
+ */
+int ht_snap_load_table(ht_t *ht)
+{
+	ht_snap_hdr_t *hdr;
+	ht_snap_rec_t *rec;
+	struct stat sb;
+	char *fpath = NULL;
+	char *mbuf = MAP_FAILED;
+	char *p;
+	char *end;
+	time_t now;
+	uint64_t n;
+	str kname;
+	int_str val;
+	int exv;
+	int fd = -1;
+	int loaded = 0;
+
+	if(!ht_snap_enabled() || ht == NULL || ht->entries == NULL)
+		return -1;
+
+	fpath = ht_snap_path(ht, 0);
+	if(fpath == NULL)
+		return -1;
+
+	fd = open(fpath, O_RDONLY);
+	if(fd < 0) {
+		LM_DBG("no snapshot file [%s] for htable [%.*s]\n", fpath,
+				ht->name.len, ht->name.s);
+		goto error;
+	}
+	if(fstat(fd, &sb) < 0 || (size_t)sb.st_size < sizeof(ht_snap_hdr_t)) {
+		LM_ERR("invalid snapshot file [%s]\n", fpath);
+		goto error;
+	}
+	mbuf = mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if(mbuf == MAP_FAILED) {
+		LM_ERR("cannot map snapshot file [%s]\n", fpath);
+		goto error;
+	}
+	end = mbuf + sb.st_size;
+
+	hdr = (ht_snap_hdr_t *)mbuf;
+	if(memcmp(hdr->magic, HT_SNAP_MAGIC, 4) != 0
+			|| hdr->version != HT_SNAP_VERSION
+			|| hdr->hdrsize != sizeof(ht_snap_hdr_t)
+			|| hdr->namelen != ht->name.len
+			|| mbuf + hdr->hdrsize + hdr->namelen > end
+			|| memcmp(mbuf + hdr->hdrsize, ht->name.s, ht->name.len) != 0) {
+		LM_ERR("snapshot file [%s] does not match htable [%.*s]\n", fpath,
+				ht->name.len, ht->name.s);
+		goto error;
+	}
+
+	now = time(NULL);
+	if(ht_snapshot_max_age > 0
+			&& (int64_t)now - hdr->stime > (int64_t)ht_snapshot_max_age) {
+		LM_INFO("snapshot file [%s] for htable [%.*s] is older than %d "
+				"seconds - ignoring it\n",
+				fpath, ht->name.len, ht->name.s, ht_snapshot_max_age);
+		goto error;
+	}
+	p = mbuf + hdr->hdrsize + HT_SNAP_ALIGN(hdr->namelen);
+	for(n = 0; n < hdr->nitems; n++) {
+		if(p + sizeof(ht_snap_rec_t) > end)
+			goto error_format;
+		rec = (ht_snap_rec_t *)p;
+		p += sizeof(ht_snap_rec_t);
+		if(rec->klen == 0 || (size_t)(end - p) < rec->klen
+				|| (size_t)(end - p) - rec->klen < rec->vlen)
+			goto error_format;
+		kname.s = p;
+		kname.len = rec->klen;
+		if(rec->flags & AVP_VAL_STR) {
+			val.s.s = p + rec->klen;
+			val.s.len = rec->vlen;
+		} else {
+			val.n = (long)rec->ival;
+		}
+		p += HT_SNAP_ALIGN((size_t)rec->klen + rec->vlen);
+
+		exv = 0;
+		if(ht->htexpire > 0 && rec->expire != 0) {
+			if(rec->expire < now) {
+				continue;
+			}
+			exv = (int)(rec->expire - now);
+			if(exv == 0)
+				exv = 1;
+		}
+		if(ht_set_cell_ex(ht, &kname, rec->flags & AVP_VAL_STR, &val, 0, exv)
+				!= 0) {
+			LM_ERR("failed to add item from snapshot in htable [%.*s]\n",
+					ht->name.len, ht->name.s);
+			goto error;
+		}
+		loaded++;
+	}
+
+	ht->snaptime = (time_t)hdr->stime;
+	LM_INFO("htable [%.*s] - restored %d items from snapshot [%s] taken at "
+			"%llu\n",
+			ht->name.len, ht->name.s, loaded, fpath,
+			(unsigned long long)hdr->stime);
+	munmap(mbuf, sb.st_size);
+	close(fd);
+	pkg_free(fpath);
+	return loaded;
+
+error_format:
+	LM_ERR("truncated or corrupted snapshot file [%s]\n", fpath);
+error:
+	if(mbuf != MAP_FAILED)
+		munmap(mbuf, sb.st_size);
+	if(fd >= 0)
+		close(fd);
+	pkg_free(fpath);
+	if(loaded > 0) {
+		/* do not keep partial content */
+		ht_reset_content(ht);
+	}
+	return -1;
+}
+
+/**
+ *
+ */
+int ht_snap_save_tables(void)
+{
+	ht_t *ht;
+
+	if(!ht_snap_enabled())
+		return 0;
+
+	for(ht = ht_get_root(); ht != NULL; ht = ht->next) {
+		if(ht->snapshot == 0)
+			continue;
+		if(ht_snap_save_table(ht) != 0) {
+			LM_ERR("failed to save snapshot for htable [%.*s]\n", ht->name.len,
+					ht->name.s);
+		}
+	}
+	return 0;
+}
+
+/**
+ *
+ */
+int ht_snap_load_tables(void)
+{
+	ht_t *ht;
+
+	if(!ht_snap_enabled())
+		return 0;
+
+	for(ht = ht_get_root(); ht != NULL; ht = ht->next) {
+		if(ht->snapshot == 0)
+			continue;
+		if(ht_snap_load_table(ht) < 0) {
+			LM_INFO("no usable snapshot for htable [%.*s] - falling back to "
+					"database\n",
+					ht->name.len, ht->name.s);
+		}
+	}
+	return 0;
+}
+
+/**
+ *
+ */
+void ht_snap_timer(unsigned int ticks, void *param)
+{
+	ht_snap_save_tables();
+}
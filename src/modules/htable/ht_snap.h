@@ -0,0 +1,43 @@
+/**
+ * Copyright (C) 2026 kamailio.org
+ *
+ * This file is part of Kamailio, a free SIP server.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Kamailio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version
+ *
+ * Kamailio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _HT_SNAP_H_
+#define _HT_SNAP_H_
+
+#include "ht_api.h"
+
+#define HT_SNAP_MAGIC "KHTS"
+#define HT_SNAP_VERSION 1
+#define HT_SNAP_SUFFIX ".htsnap"
+
+extern str ht_snapshot_dir;
+extern int ht_snapshot_interval;
+extern int ht_snapshot_max_age;
+
+int ht_snap_enabled(void);
+int ht_snap_save_table(ht_t *ht);
+int ht_snap_load_table(ht_t *ht);
+int ht_snap_save_tables(void);
+int ht_snap_load_tables(void);
+void ht_snap_timer(unsigned int ticks, void *param);
+
+#endif
@@ -47,6 +47,7 @@
 #include "ht_var.h"
 #include "api.h"
 #include "ht_dmq.h"
+#include "ht_snap.h"
 
 
 MODULE_VERSION
@@ -56,6 +57,7 @@ int ht_db_expires_flag = 0;
 int ht_enable_dmq = 0;
 int ht_dmq_init_sync = 0;
 int ht_timer_procs = 0;
+int ht_lockfree_grace = 2;
 static int ht_event_callback_mode = 0;
 
 str ht_event_callback = STR_NULL;
@@ -194,6 +196,10 @@ static param_export_t params[] = {
 	{"timer_procs", PARAM_INT, &ht_timer_procs},
 	{"event_callback", PARAM_STR, &ht_event_callback},
 	{"event_callback_mode", PARAM_INT, &ht_event_callback_mode},
+	{"snapshot_dir", PARAM_STR, &ht_snapshot_dir},
+	{"snapshot_interval", PARAM_INT, &ht_snapshot_interval},
+	{"snapshot_max_age", PARAM_INT, &ht_snapshot_max_age},
+	{"lockfree_grace", PARAM_INT, &ht_lockfree_grace},
 	{0, 0, 0}
 };
 
@@ -227,6 +233,9 @@ static int mod_init(void)
 		return -1;
 	ht_db_init_params();
 
+	if(ht_snap_load_tables() != 0)
+		return -1;
+
 	if(ht_db_url.len > 0) {
 		if(ht_db_init_con() != 0)
 			return -1;
@@ -252,6 +261,19 @@ static int mod_init(void)
 		}
 	}
 
+	if(ht_snap_enabled() && ht_snapshot_interval > 0) {
+		register_basic_timers(1);
+	}
+
+	if(ht_has_lockfree()) {
+		if(ht_lockfree_grace <= 0)
+			ht_lockfree_grace = 2;
+		if(register_timer(ht_lockfree_timer, 0, ht_lockfree_grace) < 0) {
+			LM_ERR("failed to register lockfree timer function\n");
+			return -1;
+		}
+	}
+
 	if(ht_enable_dmq > 0 && ht_dmq_initialize() != 0) {
 		LM_ERR("failed to initialize dmq integration\n");
 		return -1;
@@ -287,6 +309,14 @@ static int child_init(int rank)
 				}
 			}
 		}
+		if(ht_snap_enabled() && ht_snapshot_interval > 0) {
+			if(fork_basic_timer(PROC_TIMER, "HTable Snapshot", 1 /*socks flag*/,
+					   ht_snap_timer, NULL, ht_snapshot_interval)
+					< 0) {
+				LM_ERR("failed to start snapshot timer routine as process\n");
+				return -1; /* error */
+			}
+		}
 	}
 
 	if(ht_event_callback_mode == 0 && rank != PROC_INIT)
@@ -354,6 +384,8 @@ static void destroy(void)
 			}
 		}
 	}
+	/* write snapshots */
+	ht_snap_save_tables();
 }
 
 /**
@@ -1676,6 +1708,10 @@ static const char *htable_store_doc[2] = {
 	"Store hash table to database.",
 	0
 };
+static const char *htable_snapshot_doc[2] = {
+	"Write hash table snapshot file.",
+	0
+};
 static const char *htable_dmqsync_doc[2] = {
 	"Perform DMQ sync action.",
 	0
@@ -2189,11 +2225,13 @@ int ht_reload_table(ht_t *ht)
 	}
 
 	/* replace old entries */
+	membar_write();
 	for(i = 0; i < nht.htsize; i++) {
 		ht_slot_lock(ht, i);
 		first = ht->entries[i].first;
 		ht->entries[i].first = nht.entries[i].first;
 		ht->entries[i].esize = nht.entries[i].esize;
+		ht->entries[i].next_expire = 0;
 		ht_slot_unlock(ht, i);
 		nht.entries[i].first = first;
 	}
@@ -2205,7 +2243,7 @@ int ht_reload_table(ht_t *ht)
 		while(first) {
 			it = first;
 			first = first->next;
-			ht_cell_free(it);
+			ht_cell_release(ht, it);
 		}
 	}
 	free(nht.entries);
@@ -2288,6 +2326,33 @@ static void htable_rpc_store(rpc_t *rpc, void *c)
 	return;
 }
 
+/*! \brief RPC htable.snapshot command to write a hash table snapshot file */
+static void htable_rpc_snapshot(rpc_t *rpc, void *c)
+{
+	str htname;
+	ht_t *ht;
+
+	if(!ht_snap_enabled()) {
+		rpc->fault(c, 500, "No htable snapshot_dir");
+		return;
+	}
+	if(rpc->scan(c, "S", &htname) < 1) {
+		rpc->fault(c, 500, "No htable name given");
+		return;
+	}
+	ht = ht_get_table(&htname);
+	if(ht == NULL) {
+		rpc->fault(c, 500, "No such htable");
+		return;
+	}
+	if(ht_snap_save_table(ht) != 0) {
+		rpc->fault(c, 500, "Writing htable snapshot failed");
+		return;
+	}
+	rpc->rpl_printf(c, "Ok. Htable snapshot written.");
+	return;
+}
+
 /*! \brief RPC htable.dmqsync command to sync a hash table via dmq */
 static void htable_rpc_dmqsync(rpc_t *rpc, void *c)
 {
@@ -2346,6 +2411,7 @@ rpc_export_t htable_rpc[] = {
 	{"htable.store", htable_rpc_store, htable_store_doc, 0},
 	{"htable.stats", htable_rpc_stats, htable_stats_doc, RET_ARRAY},
 	{"htable.flush", htable_rpc_flush, htable_flush_doc, 0},
+	{"htable.snapshot", htable_rpc_snapshot, htable_snapshot_doc, 0},
 	{"htable.dmqsync", htable_rpc_dmqsync, htable_dmqsync_doc, 0},
 	{"htable.dmqresync", htable_rpc_dmqresync, htable_dmqresync_doc, 0},
 	{0, 0, 0, 0}
@@ -182,21 +182,6 @@ int rule_hash_table_insert_target(struct rule_info **hash_table,
 }
 
 
-/*
- * Return pointer to lcr hash table entry to which given prefix hashes to.
- */
-struct rule_info *rule_hash_table_lookup(
-		struct rule_info **hash_table, unsigned short prefix_len, char *prefix)
-{
-	str prefix_str;
-
-	prefix_str.len = prefix_len;
-	prefix_str.s = prefix;
-
-	return (hash_table)[rule_hash(&prefix_str)];
-}
-
-
 /* Free contents of lcr hash table */
 void rule_hash_table_contents_free(struct rule_info **hash_table)
 {
@@ -248,3 +233,106 @@ void rule_id_hash_table_contents_free()
 		rule_id_hash_table[i] = NULL;
 	}
 }
+
+
+/* Get the child of trie node with given char, adding it if requested */
+static struct rule_trie *rule_trie_child(
+		struct rule_trie *node, char c, int add)
+{
+	struct rule_trie *t;
+
+	for(t = node->child; t; t = t->next) {
+		if(t->c == c)
+			return t;
+	}
+	if(!add)
+		return NULL;
+	t = (struct rule_trie *)shm_malloc(sizeof(struct rule_trie));
+	if(t == NULL) {
+		SHM_MEM_ERROR_FMT("for rule trie node\n");
+		return NULL;
+	}
+	memset(t, 0, sizeof(struct rule_trie));
+	t->c = c;
+	t->next = node->child;
+	node->child = t;
+	return t;
+}
+
+
+/*
+ * Build the prefix trie of the rules in the hash table. Rules with the same
+ * prefix keep the order they have in the hash table.
+ */
+int rule_trie_build(struct rule_info **hash_table, struct rule_trie **root)
+{
+	int i, j;
+	struct rule_info *r, **last;
+	struct rule_trie *node;
+
+	*root = (struct rule_trie *)shm_malloc(sizeof(struct rule_trie));
+	if(*root == NULL) {
+		SHM_MEM_ERROR_FMT("for rule trie root\n");
+		return -1;
+	}
+	memset(*root, 0, sizeof(struct rule_trie));
+
+	for(i = 0; i < lcr_rule_hash_size_param; i++) {
+		for(r = hash_table[i]; r; r = r->next) {
+			node = *root;
+			for(j = 0; j < r->prefix_len; j++) {
+				node = rule_trie_child(node, r->prefix[j], 1);
+				if(node == NULL)
+					return -1;
+			}
+			last = &node->rules;
+			while(*last)
+				last = &(*last)->tnext;
+			r->tnext = NULL;
+			*last = r;
+		}
+	}
+	return 0;
+}
+
+
+/*
+ * Walk the trie along the user and store in matched the nodes having rules,
+ * from the shortest to the longest prefix. Return the number of nodes.
+ */
+int rule_trie_lookup(
+		struct rule_trie *root, str *user, struct rule_trie **matched)
+{
+	int i, n;
+	struct rule_trie *node;
+
+	n = 0;
+	node = root;
+	if(node == NULL)
+		return 0;
+	if(node->rules)
+		matched[n++] = node;
+	for(i = 0; i < user->len && i < MAX_PREFIX_LEN; i++) {
+		node = rule_trie_child(node, user->s[i], 0);
+		if(node == NULL)
+			break;
+		if(node->rules)
+			matched[n++] = node;
+	}
+	return n;
+}
+
+
+/* Free the trie nodes, the rules are freed with the hash table */
+void rule_trie_free(struct rule_trie *node)
+{
+	struct rule_trie *t, *next_t;
+
+	if(node == NULL)
+		return;
+	for(t = node->child; t; t = next_t) {
+		next_t = t->next;
+		rule_trie_free(t);
+	}
+	shm_free(node);
+}
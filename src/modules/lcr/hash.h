@@ -45,11 +45,15 @@ int rule_hash_table_insert_target(struct rule_info **hash_table,
 		struct gw_info *gws, unsigned int rule_id, unsigned int gw_id,
 		unsigned int priority, unsigned int weight);
 
-struct rule_info *rule_hash_table_lookup(
-		struct rule_info **hash_table, unsigned short prefix_len, char *prefix);
-
 void rule_hash_table_contents_free(struct rule_info **hash_table);
 
+int rule_trie_build(struct rule_info **hash_table, struct rule_trie **root);
+
+int rule_trie_lookup(struct rule_trie *root, str *user,
+		struct rule_trie **matched);
+
+void rule_trie_free(struct rule_trie *node);
+
 void rule_id_hash_table_contents_free();
 
 #endif
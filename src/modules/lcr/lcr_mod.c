@@ -235,6 +235,9 @@ static avp_name_t  mt_pv_values_avp;
 /* Pointer to rule hash table pointer table */
 struct rule_info ***rule_pt = (struct rule_info ***)NULL;
 
+/* prefix trie pointer table, rule tries are swapped with rule hash tables */
+struct rule_trie **rule_trie_pt = (struct rule_trie **)NULL;
+
 /* Pointer to gw table pointer table */
 struct gw_info **gw_pt = (struct gw_info **)NULL;
 
@@ -740,6 +743,14 @@ static int mod_init(void)
 	}
 	memset(rule_pt, 0, sizeof(struct rule_info **) * (lcr_count_param + 1));
 
+	rule_trie_pt = (struct rule_trie **)shm_malloc(
+			sizeof(struct rule_trie *) * (lcr_count_param + 1));
+	if(rule_trie_pt == 0) {
+		SHM_MEM_ERROR_FMT("for rule trie pointer table\n");
+		goto err;
+	}
+	memset(rule_trie_pt, 0, sizeof(struct rule_trie *) * (lcr_count_param + 1));
+
 	/* rules hash tables */
 	/* last entry in hash table contains list of different prefix lengths */
 	for(i = 0; i <= lcr_count_param; i++) {
@@ -852,6 +863,13 @@ static void free_shared_memory(void)
 		shm_free(rule_pt);
 		rule_pt = 0;
 	}
+	if(rule_trie_pt) {
+		for(i = 0; i <= lcr_count_param; i++) {
+			rule_trie_free(rule_trie_pt[i]);
+		}
+		shm_free(rule_trie_pt);
+		rule_trie_pt = 0;
+	}
 	for(i = 0; i <= lcr_count_param; i++) {
 		if(gw_pt && gw_pt[i]) {
 			shm_free(gw_pt[i]);
@@ -1453,6 +1471,7 @@ int reload_tables()
 	pcre2_code *from_uri_re, *request_uri_re;
 	struct gw_info *gws, *gw_pt_tmp;
 	struct rule_info **rules, **rule_pt_tmp;
+	struct rule_trie *rule_trie_tmp;
 
 	key_cols[0] = &lcr_id_col;
 	op[0] = OP_EQ;
@@ -1507,6 +1526,8 @@ int reload_tables()
 		/* Reload rules */
 
 		rules = rule_pt[0];
+		rule_trie_free(rule_trie_pt[0]);
+		rule_trie_pt[0] = NULL;
 		rule_hash_table_contents_free(rules);
 		rule_id_hash_table_contents_free();
 
@@ -1886,13 +1907,21 @@ int reload_tables()
 		lcr_dbf.free_result(dbh, res);
 		res = NULL;
 
+		if(rule_trie_build(rules, &rule_trie_pt[0]) < 0) {
+			LM_ERR("failed to build rule prefix trie\n");
+			goto err;
+		}
+
 		/* Swap tables */
 		rule_pt_tmp = rule_pt[lcr_id];
 		gw_pt_tmp = gw_pt[lcr_id];
+		rule_trie_tmp = rule_trie_pt[lcr_id];
 		rule_pt[lcr_id] = rules;
 		gw_pt[lcr_id] = gws;
+		rule_trie_pt[lcr_id] = rule_trie_pt[0];
 		rule_pt[0] = rule_pt_tmp;
 		gw_pt[0] = gw_pt_tmp;
+		rule_trie_pt[0] = rule_trie_tmp;
 	}
 
 	lcr_db_close();
@@ -2158,6 +2187,26 @@ void add_gws_into_avps(struct gw_info *gws, struct matched_gw_info *matched_gws,
 }
 
 
+/*
+ * Match subject against from_uri/request_uri regex of a rule using match
+ * data allocated once per process
+ */
+static int lcr_re_match(pcre2_code *re, str *subject)
+{
+	static pcre2_match_data *pcre_md = NULL;
+
+	if(pcre_md == NULL) {
+		/* only match or no match is needed, not the substrings */
+		pcre_md = pcre2_match_data_create(1, NULL);
+		if(pcre_md == NULL) {
+			LM_ERR("failed to allocate pcre2 match data\n");
+			return -1;
+		}
+	}
+	return pcre2_match(re, (PCRE2_SPTR)subject->s, (PCRE2_SIZE)subject->len,
+			0, 0, pcre_md, NULL);
+}
+
 /*
  * Loads ids matching GWs in priority order into gw_indexes array.
  * Returns the number of entries in the array.
@@ -2165,12 +2214,12 @@ void add_gws_into_avps(struct gw_info *gws, struct matched_gw_info *matched_gws,
 int load_gws_dummy(int lcr_id, str *ruri_user, str *from_uri, str *request_uri,
 		unsigned int *gw_indexes)
 {
-	int i, j, rc;
+	int i, j, rc, n;
 	unsigned int gw_index, now, dex;
-	struct rule_info **rules, *rule, *pl;
+	struct rule_info *rule;
+	struct rule_trie *tmatch[MAX_PREFIX_LEN + 1];
 	struct gw_info *gws;
 	struct target *t;
-	pcre2_match_data *pcre_md = NULL;
 	struct matched_gw_info matched_gws[MAX_NO_OF_GWS + 1];
 	struct sip_uri furi;
 	struct usr_avp *avp;
@@ -2189,9 +2238,7 @@ int load_gws_dummy(int lcr_id, str *ruri_user, str *from_uri, str *request_uri,
 			ruri_user->s, from_uri->len, from_uri->s, request_uri->len,
 			request_uri->s);
 
-	rules = rule_pt[lcr_id];
 	gws = gw_pt[lcr_id];
-	pl = rules[lcr_rule_hash_size_param];
 	gw_index = 0;
 
 	if((from_uri->len > 0) && mt_pv_values_param) {
@@ -2203,27 +2250,15 @@ int load_gws_dummy(int lcr_id, str *ruri_user, str *from_uri, str *request_uri,
 
 	now = time((time_t *)NULL);
 
-	while(pl) {
-		if(ruri_user->len < pl->prefix_len) {
-			pl = pl->next;
-			continue;
-		}
-		rule = rule_hash_table_lookup(rules, pl->prefix_len, ruri_user->s);
+	/* all prefixes of ruri user with rules, in one walk of the trie */
+	n = rule_trie_lookup(rule_trie_pt[lcr_id], ruri_user, tmatch);
+	while(n > 0) {
+		n--;
+		rule = tmatch[n]->rules;
 		while(rule) {
 
-			if((rule->prefix_len != pl->prefix_len)
-					|| strncmp(rule->prefix, ruri_user->s, pl->prefix_len))
-				goto next;
-
 			if(rule->from_uri_len != 0) {
-				pcre_md = pcre2_match_data_create_from_pattern(
-						rule->from_uri_re, NULL);
-				rc = pcre2_match(rule->from_uri_re, (PCRE2_SPTR)from_uri->s,
-						(PCRE2_SIZE)from_uri->len, 0, 0, pcre_md, NULL);
-				if(pcre_md) {
-					pcre2_match_data_free(pcre_md);
-					pcre_md = NULL;
-				}
+				rc = lcr_re_match(rule->from_uri_re, from_uri);
 				if(rc < 0)
 					goto next;
 			}
@@ -2259,15 +2294,7 @@ int load_gws_dummy(int lcr_id, str *ruri_user, str *from_uri, str *request_uri,
 						   "param has not been given.\n");
 					return -1;
 				}
-				pcre_md = pcre2_match_data_create_from_pattern(
-						rule->request_uri_re, NULL);
-				rc = pcre2_match(rule->request_uri_re,
-						(PCRE2_SPTR)request_uri->s,
-						(PCRE2_SIZE)request_uri->len, 0, 0, pcre_md, NULL);
-				if(pcre_md) {
-					pcre2_match_data_free(pcre_md);
-					pcre_md = NULL;
-				}
+				rc = lcr_re_match(rule->request_uri_re, request_uri);
 				if(rc < 0)
 					goto next;
 			}
@@ -2279,12 +2306,12 @@ int load_gws_dummy(int lcr_id, str *ruri_user, str *from_uri, str *request_uri,
 					goto skip_gw;
 				matched_gws[gw_index].gw_index = t->gw_index;
 				matched_gws[gw_index].rule_id = rule->rule_id;
-				matched_gws[gw_index].prefix_len = pl->prefix_len;
+				matched_gws[gw_index].prefix_len = rule->prefix_len;
 				matched_gws[gw_index].priority = t->priority;
 				matched_gws[gw_index].weight = t->weight * (kam_rand() >> 8);
 				matched_gws[gw_index].duplicate = 0;
 				LM_DBG("added matched_gws[%d]=[%u, %u, %u, %u]\n", gw_index,
-						t->gw_index, pl->prefix_len, t->priority,
+						t->gw_index, rule->prefix_len, t->priority,
 						matched_gws[gw_index].weight);
 				gw_index++;
 			skip_gw:
@@ -2294,9 +2321,8 @@ int load_gws_dummy(int lcr_id, str *ruri_user, str *from_uri, str *request_uri,
 				goto done;
 
 		next:
-			rule = rule->next;
+			rule = rule->tnext;
 		}
-		pl = pl->next;
 	}
 
 done:
@@ -2332,12 +2358,12 @@ static int ki_load_gws_furi(
 		sip_msg_t *_m, int lcr_id, str *ruri_user, str *from_uri)
 {
 	str *request_uri;
-	int i, j, rc;
+	int i, j, rc, n;
 	unsigned int gw_index, now, dex;
 	int_str val;
-	pcre2_match_data *pcre_md = NULL;
 	struct matched_gw_info matched_gws[MAX_NO_OF_GWS + 1];
-	struct rule_info **rules, *rule, *pl;
+	struct rule_info *rule;
+	struct rule_trie *tmatch[MAX_PREFIX_LEN + 1];
 	struct gw_info *gws;
 	struct target *t;
 	struct sip_uri furi;
@@ -2362,7 +2388,6 @@ static int ki_load_gws_furi(
 	}
 
 	/* Use rules and gws with index lcr_id */
-	rules = rule_pt[lcr_id];
 	gws = gw_pt[lcr_id];
 
 	/*
@@ -2371,7 +2396,6 @@ static int ki_load_gws_furi(
      * gateway appears in the array only once.
      */
 
-	pl = rules[lcr_rule_hash_size_param];
 	gw_index = 0;
 
 	if(defunct_capability_param > 0) {
@@ -2380,29 +2404,16 @@ static int ki_load_gws_furi(
 
 	now = time((time_t *)NULL);
 
-	/* check prefixes in from longest to shortest */
-	while(pl) {
-		if(ruri_user->len < pl->prefix_len) {
-			pl = pl->next;
-			continue;
-		}
-		rule = rule_hash_table_lookup(rules, pl->prefix_len, ruri_user->s);
+	/* check prefixes in from longest to shortest, the prefixes of ruri user
+	 * with rules are collected in one walk of the trie */
+	n = rule_trie_lookup(rule_trie_pt[lcr_id], ruri_user, tmatch);
+	while(n > 0) {
+		n--;
+		rule = tmatch[n]->rules;
 		while(rule) {
-			/* Match prefix */
-			if((rule->prefix_len != pl->prefix_len)
-					|| (strncmp(rule->prefix, ruri_user->s, pl->prefix_len)))
-				goto next;
-
 			/* Match from uri */
 			if(rule->from_uri_len != 0) {
-				pcre_md = pcre2_match_data_create_from_pattern(
-						rule->from_uri_re, NULL);
-				rc = pcre2_match(rule->from_uri_re, (PCRE2_SPTR)from_uri->s,
-						(PCRE2_SIZE)from_uri->len, 0, 0, pcre_md, NULL);
-				if(pcre_md) {
-					pcre2_match_data_free(pcre_md);
-					pcre_md = NULL;
-				}
+				rc = lcr_re_match(rule->from_uri_re, from_uri);
 				if(rc < 0) {
 					LM_DBG("from uri <%.*s> did not match to from regex "
 						   "<%.*s>\n",
@@ -2439,15 +2450,7 @@ static int ki_load_gws_furi(
 
 			/* Match request uri */
 			if(rule->request_uri_len != 0) {
-				pcre_md = pcre2_match_data_create_from_pattern(
-						rule->request_uri_re, NULL);
-				rc = pcre2_match(rule->request_uri_re,
-						(PCRE2_SPTR)request_uri->s,
-						(PCRE2_SIZE)request_uri->len, 0, 0, pcre_md, NULL);
-				if(pcre_md) {
-					pcre2_match_data_free(pcre_md);
-					pcre_md = NULL;
-				}
+				rc = lcr_re_match(rule->request_uri_re, request_uri);
 				if(rc < 0) {
 					LM_DBG("request uri <%.*s> did not match to request regex "
 						   "<%.*s>\n",
@@ -2466,12 +2469,12 @@ static int ki_load_gws_furi(
 					goto skip_gw;
 				matched_gws[gw_index].gw_index = t->gw_index;
 				matched_gws[gw_index].rule_id = rule->rule_id;
-				matched_gws[gw_index].prefix_len = pl->prefix_len;
+				matched_gws[gw_index].prefix_len = rule->prefix_len;
 				matched_gws[gw_index].priority = t->priority;
 				matched_gws[gw_index].weight = t->weight * (kam_rand() >> 8);
 				matched_gws[gw_index].duplicate = 0;
 				LM_DBG("added matched_gws[%d]=[%u, %u, %u, %u]\n", gw_index,
-						t->gw_index, pl->prefix_len, t->priority,
+						t->gw_index, rule->prefix_len, t->priority,
 						matched_gws[gw_index].weight);
 				gw_index++;
 			skip_gw:
@@ -2482,9 +2485,8 @@ static int ki_load_gws_furi(
 				goto done;
 
 		next:
-			rule = rule->next;
+			rule = rule->tnext;
 		}
-		pl = pl->next;
 	}
 
 done:
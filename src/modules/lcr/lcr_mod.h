@@ -72,6 +72,16 @@ struct rule_info
 	unsigned int enabled;
 	struct target *targets;
 	struct rule_info *next;
+	struct rule_info *tnext; /* next rule with the same prefix (trie) */
+};
+
+/* prefix trie node, the root is the empty prefix */
+struct rule_trie
+{
+	char c;
+	struct rule_info *rules; /* rules with the prefix ending here */
+	struct rule_trie *child;
+	struct rule_trie *next;
 };
 
 struct rule_id_info
@@ -147,6 +157,7 @@ extern gen_lock_t *reload_lock;
 
 extern struct gw_info **gw_pt;
 extern struct rule_info ***rule_pt;
+extern struct rule_trie **rule_trie_pt;
 extern struct rule_id_info **rule_id_hash_table;
 
 extern int load_gws_dummy(int lcr_id, str *ruri_user, str *from_uri,
@@ -59,6 +59,64 @@ static unsigned char _mt_char_table[MT_CHAR_TABLE_SIZE];
 
 static int _mt_char_table_ready = 0;
 
+/* size limits of the memory blocks allocated for tree data */
+#define MT_ARENA_MIN_SIZE (16 * 1024)
+#define MT_ARENA_MAX_SIZE (4 * 1024 * 1024)
+
+/**
+ * allocate memory for tree data from the blocks of the tree
+ * - the blocks are allocated with growing size, so large trees do not do
+ *   one shm allocation per node and value, and the memory is released at
+ *   once with mt_arena_free()
+ */
+static void *mt_arena_alloc(m_tree_t *pt, unsigned int size)
+{
+	mt_arena_t *a;
+	unsigned int bsize;
+	void *p;
+
+	size = (size + 7) & ~7U;
+	a = pt->arena;
+	if(a == NULL || a->size - a->used < size) {
+		if(a == NULL) {
+			bsize = MT_ARENA_MIN_SIZE;
+		} else if(a->size < MT_ARENA_MAX_SIZE / 2) {
+			bsize = 2 * a->size;
+		} else {
+			bsize = MT_ARENA_MAX_SIZE;
+		}
+		if(bsize < size) {
+			bsize = size;
+		}
+		a = (mt_arena_t *)shm_malloc(sizeof(mt_arena_t) + bsize);
+		if(a == NULL) {
+			SHM_MEM_ERROR;
+			return NULL;
+		}
+		a->size = bsize;
+		a->used = 0;
+		a->next = pt->arena;
+		pt->arena = a;
+	}
+	p = (char *)a + sizeof(mt_arena_t) + a->used;
+	a->used += size;
+	return p;
+}
+
+/**
+ * free all memory blocks of a tree
+ */
+void mt_arena_free(mt_arena_t *arena)
+{
+	mt_arena_t *a;
+
+	while(arena != NULL) {
+		a = arena;
+		arena = arena->next;
+		shm_free(a);
+	}
+}
+
 /**
  *
  */
@@ -240,7 +298,8 @@ int mt_add_to_tree(m_tree_t *pt, str *sp, str *svalue)
 
 	l = 0;
 	if(pt->head == NULL) {
-		pt->head = (mt_node_t *)shm_malloc(MT_NODE_SIZE * sizeof(mt_node_t));
+		pt->head = (mt_node_t *)mt_arena_alloc(
+				pt, MT_NODE_SIZE * sizeof(mt_node_t));
 		if(pt->head == NULL) {
 			LM_ERR("no more shm memory for tree head\n");
 			return -1;
@@ -262,7 +321,8 @@ int mt_add_to_tree(m_tree_t *pt, str *sp, str *svalue)
 
 	while(l < sp->len - 1) {
 		if(itn == NULL) {
-			itn = (mt_node_t *)shm_malloc(MT_NODE_SIZE * sizeof(mt_node_t));
+			itn = (mt_node_t *)mt_arena_alloc(
+					pt, MT_NODE_SIZE * sizeof(mt_node_t));
 			if(itn == NULL) {
 				LM_ERR("no more shm mem\n");
 				return -1;
@@ -295,7 +355,7 @@ int mt_add_to_tree(m_tree_t *pt, str *sp, str *svalue)
 		}
 	}
 
-	tvalues = (mt_is_t *)shm_malloc(sizeof(mt_is_t));
+	tvalues = (mt_is_t *)mt_arena_alloc(pt, sizeof(mt_is_t));
 	if(tvalues == NULL) {
 		LM_ERR("no more shm mem for tvalue\n");
 		return -1;
@@ -305,8 +365,8 @@ int mt_add_to_tree(m_tree_t *pt, str *sp, str *svalue)
 	if(pt->type == MT_TREE_IVAL) {
 		tvalues->tvalue.n = ivalue;
 	} else { /* pt->type == MT_TREE_SVAL or MT_TREE_DW */
-		tvalues->tvalue.s.s =
-				(char *)shm_malloc((svalue->len + 1) * sizeof(char));
+		tvalues->tvalue.s.s = (char *)mt_arena_alloc(
+				pt, (svalue->len + 1) * sizeof(char));
 		if(tvalues->tvalue.s.s == NULL) {
 			LM_ERR("no more shm mem for string\n");
 			return -1;
@@ -319,7 +379,7 @@ int mt_add_to_tree(m_tree_t *pt, str *sp, str *svalue)
 	}
 	tvalues->next = itn0[mtch].tvalues;
 	itn0[mtch].tvalues = tvalues;
-	mt_node_set_payload(&itn0[mtch], pt->type);
+	mt_node_set_payload(pt, &itn0[mtch]);
 	return 0;
 }
 
@@ -598,46 +658,12 @@ int mt_match_prefix(struct sip_msg *msg, m_tree_t *it, str *tomatch, int mode)
 	return 0;
 }
 
-void mt_free_node(mt_node_t *pn, int type)
-{
-	int i;
-	mt_is_t *tvalues, *next;
-
-	if(pn == NULL)
-		return;
-
-	for(i = 0; i < MT_NODE_SIZE; i++) {
-		tvalues = pn[i].tvalues;
-		while(tvalues != NULL) {
-			if((type == MT_TREE_SVAL) && (tvalues->tvalue.s.s != NULL)) {
-				shm_free(tvalues->tvalue.s.s);
-				tvalues->tvalue.s.s = NULL;
-				tvalues->tvalue.s.len = 0;
-			}
-			next = tvalues->next;
-			shm_free(tvalues);
-			tvalues = next;
-		}
-		if(type == MT_TREE_DW)
-			mt_node_unset_payload(&pn[i], type);
-		if(pn[i].child != NULL) {
-			mt_free_node(pn[i].child, type);
-			pn[i].child = NULL;
-		}
-	}
-	shm_free(pn);
-	pn = NULL;
-
-	return;
-}
-
 void mt_free_tree(m_tree_t *pt)
 {
 	if(pt == NULL)
 		return;
 
-	if(pt->head != NULL)
-		mt_free_node(pt->head, pt->type);
+	mt_arena_free(pt->arena);
 	if(pt->next != NULL)
 		mt_free_tree(pt->next);
 	if(pt->dbtable.s != NULL)
@@ -692,7 +718,7 @@ int mt_print_tree(m_tree_t *pt)
 	return mt_print_tree(pt->next);
 }
 
-int mt_node_set_payload(mt_node_t *node, int type)
+int mt_node_set_payload(m_tree_t *pt, mt_node_t *node)
 {
 	param_t *list;
 	param_t *it;
@@ -701,7 +727,7 @@ int mt_node_set_payload(mt_node_t *node, int type)
 	mt_dw_t *dwl;
 	mt_dw_t *dw;
 
-	if(type != MT_TREE_DW)
+	if(pt->type != MT_TREE_DW)
 		return 0;
 	s = node->tvalues->tvalue.s;
 	if(s.s[s.len - 1] == ';')
@@ -712,7 +738,7 @@ int mt_node_set_payload(mt_node_t *node, int type)
 	}
 	dwl = NULL;
 	for(it = list; it; it = it->next) {
-		dw = (mt_dw_t *)shm_malloc(sizeof(mt_dw_t));
+		dw = (mt_dw_t *)mt_arena_alloc(pt, sizeof(mt_dw_t));
 		if(dw == NULL) {
 			LM_ERR("no more shm\n");
 			goto error;
@@ -727,32 +753,11 @@ int mt_node_set_payload(mt_node_t *node, int type)
 	free_params(list);
 	return 0;
 error:
-	while(dwl) {
-		dw = dwl;
-		dwl = dwl->next;
-		shm_free(dwl);
-	}
+	/* allocated items are released with the tree memory */
 	free_params(list);
 	return -1;
 }
 
-int mt_node_unset_payload(mt_node_t *node, int type)
-{
-	mt_dw_t *dwl;
-	mt_dw_t *dw;
-
-	if(type != MT_TREE_DW)
-		return 0;
-	dwl = (mt_dw_t *)node->data;
-	while(dwl) {
-		dw = dwl;
-		dwl = dwl->next;
-		shm_free(dw);
-	}
-	node->data = NULL;
-	return 0;
-}
-
 int mt_table_spec(char *val)
 {
 	param_t *params_list = NULL;
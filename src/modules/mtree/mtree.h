@@ -65,6 +65,14 @@ typedef struct _mt_node
 
 #define MT_NODE_SIZE mt_char_list.len
 
+/* block of shm memory for tree nodes and values, freed at once */
+typedef struct _mt_arena
+{
+	struct _mt_arena *next;
+	unsigned int size;
+	unsigned int used;
+} mt_arena_t;
+
 #define MT_MAX_COLS 8
 typedef struct _m_tree
 {
@@ -82,6 +90,7 @@ typedef struct _m_tree
 	unsigned int reload_count;
 	uint64_t reload_time;
 	mt_node_t *head;
+	mt_arena_t *arena;
 	struct _m_tree *next;
 } m_tree_t;
 
@@ -99,11 +108,10 @@ m_tree_t *mt_init_tree(
 		str *tname, str *dbtable, str *scols, int type, int multi, int mode);
 void mt_free_tree(m_tree_t *pt);
 int mt_print_tree(m_tree_t *pt);
-void mt_free_node(mt_node_t *pn, int type);
+void mt_arena_free(mt_arena_t *arena);
 
 int mt_char_table_init(int nset);
-int mt_node_set_payload(mt_node_t *node, int type);
-int mt_node_unset_payload(mt_node_t *node, int type);
+int mt_node_set_payload(m_tree_t *pt, mt_node_t *node);
 
 int mt_table_spec(char *val);
 void mt_destroy_trees(void);
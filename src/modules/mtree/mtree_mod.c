@@ -538,7 +538,7 @@ static int mt_load_db(m_tree_t *pt)
 	int i, ret, c;
 	m_tree_t new_tree;
 	m_tree_t *old_tree = NULL;
-	mt_node_t *bk_head = NULL;
+	mt_arena_t *bk_arena = NULL;
 
 	if(pt->mode == 1) {
 		LM_DBG("skip loading db records - in-memory only tree: [%.*s]\n",
@@ -583,6 +583,7 @@ static int mt_load_db(m_tree_t *pt)
 	}
 	memcpy(&new_tree, old_tree, sizeof(m_tree_t));
 	new_tree.head = 0;
+	new_tree.arena = 0;
 	new_tree.next = 0;
 	new_tree.nrnodes = 0;
 	new_tree.nritems = 0;
@@ -688,8 +689,9 @@ dbreloaded:
 		sleep_us(10);
 	}
 
-	bk_head = old_tree->head;
+	bk_arena = old_tree->arena;
 	old_tree->head = new_tree.head;
+	old_tree->arena = new_tree.arena;
 	old_tree->nrnodes = new_tree.nrnodes;
 	old_tree->nritems = new_tree.nritems;
 	old_tree->memsize = new_tree.memsize;
@@ -699,15 +701,13 @@ dbreloaded:
 	mt_reload_flag = 0;
 
 	/* free old data */
-	if(bk_head != NULL)
-		mt_free_node(bk_head, new_tree.type);
+	mt_arena_free(bk_arena);
 
 	return 0;
 
 error:
 	mt_dbf.free_result(db_con, db_res);
-	if(new_tree.head != NULL)
-		mt_free_node(new_tree.head, new_tree.type);
+	mt_arena_free(new_tree.arena);
 	return -1;
 }
 
@@ -501,6 +501,10 @@ int reload_address_table(void)
 		return ret;
 	}
 
+	if(subnet_table_index(atg.subnet_table) < 0) {
+		LM_WARN("subnet table not indexed - using linear search\n");
+	}
+
 	*perm_addr_table = atg.address_table;
 	*perm_subnet_table = atg.subnet_table;
 	*perm_domain_table = atg.domain_table;
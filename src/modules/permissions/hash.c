@@ -478,7 +478,7 @@ int addr_hash_table_insert(struct addr_list **table, unsigned int grp,
 	}
 
 	addr_str.s = (char *)addr->u.addr;
-	addr_str.len = 4;
+	addr_str.len = addr->len;
 	hash_val = perm_hash(addr_str);
 	np->next = table[hash_val];
 	table[hash_val] = np;
@@ -499,7 +499,7 @@ int match_addr_hash_table(struct addr_list **table, unsigned int group,
 	avp_value_t val;
 
 	addr_str.s = (char *)addr->u.addr;
-	addr_str.len = 4;
+	addr_str.len = addr->len;
 
 	for(np = table[perm_hash(addr_str)]; np != NULL; np = np->next) {
 		if((np->grp == group) && ((np->port == 0) || (np->port == port))
@@ -534,7 +534,7 @@ int find_group_in_addr_hash_table(
 	avp_value_t val;
 
 	addr_str.s = (char *)addr->u.addr;
-	addr_str.len = 4;
+	addr_str.len = addr->len;
 
 	for(np = table[perm_hash(addr_str)]; np != NULL; np = np->next) {
 		if(((np->port == 0) || (np->port == port))
@@ -691,6 +691,140 @@ int subnet_table_insert(struct subnet *table, unsigned int grp,
 }
 
 
+/*
+ * Free the nodes of the subnet index tree
+ */
+static void subnet_tree_free(struct subnet_node *node)
+{
+	if(node == NULL)
+		return;
+	subnet_tree_free(node->child[0]);
+	subnet_tree_free(node->child[1]);
+	shm_free(node);
+}
+
+
+/*
+ * Release the index tree of the subnet table
+ */
+static void subnet_table_unindex(struct subnet *table)
+{
+	struct subnet_node *tree;
+
+	tree = table[PERM_MAX_SUBNETS].tree;
+	if(tree == NULL)
+		return;
+	table[PERM_MAX_SUBNETS].tree = NULL;
+	subnet_tree_free(tree[0].child[0]);
+	subnet_tree_free(tree[0].child[1]);
+	subnet_tree_free(tree[1].child[0]);
+	subnet_tree_free(tree[1].child[1]);
+	shm_free(tree);
+}
+
+
+/*
+ * Build the binary prefix tree of the subnet table - each subnet record is
+ * linked to the node at the depth of its mask, records with same prefix
+ * being chained in increasing table order
+ */
+int subnet_table_index(struct subnet *table)
+{
+	struct subnet_node *tree;
+	struct subnet_node *node;
+	unsigned int count;
+	unsigned int b;
+	int i;
+	int k;
+
+	subnet_table_unindex(table);
+
+	tree = (struct subnet_node *)shm_malloc(2 * sizeof(struct subnet_node));
+	if(tree == NULL) {
+		LM_ERR("no shm memory for subnet index\n");
+		return -1;
+	}
+	memset(tree, 0, 2 * sizeof(struct subnet_node));
+	tree[0].idx = -1;
+	tree[1].idx = -1;
+
+	count = table[PERM_MAX_SUBNETS].grp;
+	for(i = (int)count - 1; i >= 0; i--) {
+		node = &tree[(table[i].subnet.af == AF_INET6) ? 1 : 0];
+		for(k = 0; k < (int)table[i].mask; k++) {
+			b = (table[i].subnet.u.addr[k >> 3] >> (7 - (k & 7))) & 1;
+			if(node->child[b] == NULL) {
+				node->child[b] = (struct subnet_node *)shm_malloc(
+						sizeof(struct subnet_node));
+				if(node->child[b] == NULL) {
+					LM_ERR("no shm memory for subnet index node\n");
+					table[PERM_MAX_SUBNETS].tree = tree;
+					subnet_table_unindex(table);
+					return -1;
+				}
+				memset(node->child[b], 0, sizeof(struct subnet_node));
+				node->child[b]->idx = -1;
+			}
+			node = node->child[b];
+		}
+		table[i].next = node->idx;
+		node->idx = i;
+	}
+	table[PERM_MAX_SUBNETS].tree = tree;
+
+	return 0;
+}
+
+
+/*
+ * Walk the subnet index tree along the bits of ip_addr and return the
+ * position of the record that the linear scan would select, or -1
+ * - if any is set, records of all groups are considered
+ * - like in the linear scan, records with mask 0 are never selected and,
+ *   in match mode 0, such a record stops the search if it is the first
+ *   one matching in table order
+ */
+static int subnet_tree_match(struct subnet *table, int any, unsigned int grp,
+		ip_addr_t *addr, unsigned int port)
+{
+	struct subnet_node *node;
+	unsigned int b;
+	int best_idx = -1;
+	int i;
+	int k;
+
+	if(addr->af != AF_INET && addr->af != AF_INET6)
+		return -1;
+	node = &table[PERM_MAX_SUBNETS].tree[(addr->af == AF_INET6) ? 1 : 0];
+	for(k = 0; node != NULL; k++) {
+		if(k == 0 && _perm_subnet_match_mode != 0)
+			goto next;
+		/* records at a node have the same mask, chained by table position */
+		for(i = node->idx; i >= 0; i = table[i].next) {
+			if((any || table[i].grp == grp)
+					&& ((table[i].port == port) || (table[i].port == 0))) {
+				/* deeper records have longer mask, otherwise
+				 * keep the first one in table order */
+				if(_perm_subnet_match_mode != 0 || best_idx < 0
+						|| i < best_idx) {
+					best_idx = i;
+				}
+				break;
+			}
+		}
+	next:
+		if(k >= addr->len * 8)
+			break;
+		b = (addr->u.addr[k >> 3] >> (7 - (k & 7))) & 1;
+		node = node->child[b];
+	}
+
+	if(best_idx >= 0 && table[best_idx].mask == 0)
+		return -1;
+	return best_idx;
+}
+
+
 /*
  * Check if an entry exists in subnet table that matches given group, ip_addr,
  * and port.  Port 0 in subnet table matches any port.
@@ -705,6 +839,11 @@ int match_subnet_table(struct subnet *table, unsigned int grp, ip_addr_t *addr,
 
 	count = table[PERM_MAX_SUBNETS].grp;
 
+	if(table[PERM_MAX_SUBNETS].tree != NULL) {
+		best_idx = subnet_tree_match(table, 0, grp, addr, port);
+		goto done;
+	}
+
 	i = 0;
 	while((i < count) && (table[i].grp < grp))
 		i++;
@@ -728,6 +867,7 @@ int match_subnet_table(struct subnet *table, unsigned int grp, ip_addr_t *addr,
 		i++;
 	}
 
+done:
 	if(best_idx >= 0) {
 		if(tag_avp.n && table[best_idx].tag.s) {
 			val.s = table[best_idx].tag;
@@ -758,6 +898,11 @@ int find_group_in_subnet_table(
 
 	count = table[PERM_MAX_SUBNETS].grp;
 
+	if(table[PERM_MAX_SUBNETS].tree != NULL) {
+		best_idx = subnet_tree_match(table, 1, 0, addr, port);
+		goto done;
+	}
+
 	i = 0;
 	while(i < count) {
 		if(((table[i].port == port) || (table[i].port == 0))
@@ -775,6 +920,7 @@ int find_group_in_subnet_table(
 		i++;
 	}
 
+done:
 	if(best_idx >= 0) {
 		if(tag_avp.n && table[best_idx].tag.s) {
 			val.s = table[best_idx].tag;
@@ -837,6 +983,7 @@ int subnet_table_rpc_print(struct subnet *table, rpc_t *rpc, void *c)
 void empty_subnet_table(struct subnet *table)
 {
 	int i;
+	subnet_table_unindex(table);
 	table[PERM_MAX_SUBNETS].grp = 0;
 	for(i = 0; i < PERM_MAX_SUBNETS; i++) {
 		if(table[i].tag.s != NULL) {
@@ -856,6 +1003,7 @@ void free_subnet_table(struct subnet *table)
 	int i;
 	if(!table)
 		return;
+	subnet_table_unindex(table);
 	for(i = 0; i < PERM_MAX_SUBNETS; i++) {
 		if(table[i].tag.s != NULL) {
 			shm_free(table[i].tag.s);
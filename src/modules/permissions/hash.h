@@ -175,6 +175,16 @@ int addr_hash_table_rpc_print(struct addr_list **table, rpc_t *rpc, void *c);
 void empty_addr_hash_table(struct addr_list **hash_table);
 
 
+/*
+ * Node of the binary prefix tree indexing the subnet table
+ */
+struct subnet_node
+{
+	struct subnet_node *child[2];
+	int idx; /* first subnet record with the prefix of the node or -1 */
+};
+
+
 /*
  * Structure used to store a subnet
  */
@@ -186,6 +196,8 @@ struct subnet
 	unsigned int port; /* port or 0 */
 	unsigned int mask; /* how many bits belong to network part */
 	str tag;
+	int next; /* next subnet record with the same prefix in the index tree */
+	struct subnet_node *tree; /* index tree roots (IPv4, IPv6) in last record */
 };
 
 
@@ -231,6 +243,13 @@ int subnet_table_insert(struct subnet *table, unsigned int grp,
 		ip_addr_t *subnet, unsigned int mask, unsigned int port, str *tagv);
 
 
+/*
+ * Build the prefix tree index of the subnet table, to be done after
+ * all records are inserted
+ */
+int subnet_table_index(struct subnet *table);
+
+
 /*
  * Print subnets stored in subnet table
  */
@@ -32,6 +32,8 @@
 #include <unistd.h>
 #include <ctype.h>
 #include "../../core/atomic_ops.h"
+#include "../../core/bit_count.h"
+#include "../../core/mem/mem.h"
 #include "../../core/mem/shm_mem.h"
 #include "../../core/str.h"
 #include "../../core/lock_alloc.h"
@@ -45,7 +47,7 @@ enum
 };
 
 
-/** Defines a route item in the prefix tree */
+/** Defines a route item in the prefix tree being built */
 struct tree_item
 {
 	struct tree_item *digits[DIGITS]; /**< Child items for each digit */
@@ -54,11 +56,27 @@ struct tree_item
 };
 
 
+/**
+ * Defines a node of the compact tree - the children of a node are
+ * stored next to each other, in the order of the digits
+ */
+struct tree_node
+{
+	unsigned int map;	/**< Bit set for each existing child digit */
+	unsigned int child; /**< Index of the first child node         */
+	int route;			/**< Valid route number if >0              */
+};
+
+
 /** Defines a locked prefix tree */
 struct tree
 {
-	struct tree_item *root; /**< Root item of tree    */
-	atomic_t refcnt;		/**< Reference counting   */
+	struct tree_node *nodes; /**< Nodes, the root is the first one  */
+	unsigned int nnodes;	 /**< Number of nodes                   */
+	int nroutes;			 /**< Size of route names table         */
+	char (*names)[16];		 /**< Route names indexed by route      */
+	unsigned long size;		 /**< Size of the memory block          */
+	atomic_t refcnt;		 /**< Reference counting                */
 };
 
 
@@ -68,7 +86,9 @@ static gen_lock_t *shared_tree_lock;
 
 
 /**
- * Allocate and initialize a new tree item
+ * Allocate and initialize a new tree item - the items are in shared
+ * memory (large tables would not fit in the private memory pool), being
+ * used only until the tree is compacted by tree_swap()
  */
 struct tree_item *tree_item_alloc(void)
 {
@@ -167,20 +187,41 @@ out:
 }
 
 
+/**
+ * Count the items and the highest route number of a tree
+ */
+static void tree_item_count(
+		const struct tree_item *item, unsigned int *nitems, int *maxroute)
+{
+	int i;
+
+	if(NULL == item)
+		return;
+
+	(*nitems)++;
+	if(item->route > *maxroute)
+		*maxroute = item->route;
+
+	for(i = 0; i < DIGITS; i++) {
+		tree_item_count(item->digits[i], nitems, maxroute);
+	}
+}
+
+
 /**
  * Get route number from username
  */
-int tree_item_get(const struct tree_item *root, const str *user)
+static int tree_node_get(const struct tree *tree, const str *user)
 {
-	const struct tree_item *item;
+	const struct tree_node *node;
 	const char *p, *pmax;
 	int route = 0;
 
-	if(NULL == root || NULL == user || NULL == user->s || !user->len)
+	if(NULL == tree || NULL == user || NULL == user->s || !user->len)
 		return -1;
 
 	pmax = user->s + user->len;
-	item = root;
+	node = tree->nodes;
 	for(p = user->s; p < pmax; p++) {
 		int digit;
 
@@ -191,16 +232,17 @@ int tree_item_get(const struct tree_item *root, const str *user)
 		digit = *p - '0';
 
 		/* Update route with best match so far */
-		if(item->route > 0) {
-			route = item->route;
+		if(node->route > 0) {
+			route = node->route;
 		}
 
 		/* exist? */
-		if(NULL == item->digits[digit]) {
+		if(!(node->map & (1U << digit))) {
 			break;
 		}
 
-		item = item->digits[digit];
+		node = &tree->nodes[node->child
+							+ bit_count(node->map & ((1U << digit) - 1))];
 	}
 
 	return route;
@@ -208,23 +250,28 @@ int tree_item_get(const struct tree_item *root, const str *user)
 
 
 /**
- * Print one tree item to a file handle
+ * Print one tree node to a file handle
  */
-void tree_item_print(const struct tree_item *item, FILE *f, int level)
+static void tree_node_print(
+		const struct tree *tree, unsigned int idx, FILE *f, int level)
 {
+	const struct tree_node *node;
+	unsigned int child;
 	int i;
 
-	if(NULL == item || NULL == f)
+	if(NULL == f)
 		return;
 
-	if(item->route > 0) {
-		fprintf(f, " \t--> route[%s] ", item->name);
+	node = &tree->nodes[idx];
+	if(node->route > 0) {
+		fprintf(f, " \t--> route[%s] ", tree->names[node->route]);
 	}
 
+	child = node->child;
 	for(i = 0; i < DIGITS; i++) {
 		int j;
 
-		if(!item->digits[i]) {
+		if(!(node->map & (1U << i))) {
 			continue;
 		}
 
@@ -233,27 +280,78 @@ void tree_item_print(const struct tree_item *item, FILE *f, int level)
 			fputc(' ', f);
 
 		fprintf(f, "%d ", i);
-		tree_item_print(item->digits[i], f, level + 1);
+		tree_node_print(tree, child, f, level + 1);
+		child++;
 	}
 }
 
 
 /**
- * Allocate a new tree structure
+ * Allocate a new tree structure and fill it in a single memory block
+ * with the items of root, in breadth first order
  */
-static struct tree *tree_alloc(void)
+static struct tree *tree_alloc(const struct tree_item *root)
 {
 	struct tree *tree;
+	const struct tree_item **queue;
+	const struct tree_item *item;
+	struct tree_node *node;
+	unsigned int nitems = 0;
+	unsigned int head, tail;
+	int maxroute = 0;
+	unsigned long size;
+	int i;
+
+	tree_item_count(root, &nitems, &maxroute);
+	if(nitems == 0)
+		return NULL;
+
+	queue = (const struct tree_item **)shm_malloc(nitems * sizeof(*queue));
+	if(NULL == queue) {
+		SHM_MEM_CRITICAL;
+		return NULL;
+	}
 
-	tree = (struct tree *)shm_malloc(sizeof(*tree));
+	size = sizeof(*tree) + nitems * sizeof(struct tree_node)
+		   + (maxroute + 1) * sizeof(tree->names[0]);
+	tree = (struct tree *)shm_malloc(size);
 	if(NULL == tree) {
 		SHM_MEM_CRITICAL;
+		shm_free(queue);
 		return NULL;
 	}
+	memset(tree, 0, size);
 
-	tree->root = NULL;
+	tree->nodes = (struct tree_node *)(tree + 1);
+	tree->nnodes = nitems;
+	tree->nroutes = maxroute + 1;
+	tree->names = (char(*)[16])(tree->nodes + nitems);
+	tree->size = size;
 	atomic_set(&tree->refcnt, 0);
 
+	queue[0] = root;
+	head = 0;
+	tail = 1;
+	while(head < tail) {
+		item = queue[head];
+		node = &tree->nodes[head];
+		node->route = item->route;
+		if(item->route > 0) {
+			memcpy(tree->names[item->route], item->name,
+					sizeof(tree->names[0]));
+		}
+		node->child = tail;
+		for(i = 0; i < DIGITS; i++) {
+			if(item->digits[i]) {
+				node->map |= 1U << i;
+				queue[tail++] = item->digits[i];
+			}
+		}
+		head++;
+	}
+
+	shm_free(queue);
+
 	return tree;
 }
 
@@ -278,7 +376,6 @@ static void tree_flush(struct tree *tree)
 		usleep(100000);
 	};
 
-	tree_item_free(tree->root);
 	shm_free(tree);
 }
 
@@ -305,7 +402,8 @@ static struct tree *tree_ref(void)
 
 	lock_get(shared_tree_lock);
 	tree = *shared_tree;
-	atomic_inc(&tree->refcnt);
+	if(tree)
+		atomic_inc(&tree->refcnt);
 	lock_release(shared_tree_lock);
 
 	return tree;
@@ -358,16 +456,19 @@ void tree_close(void)
 }
 
 
+/**
+ * Replace the shared tree with the compacted copy of root - the items
+ * of root are released in any case
+ */
 int tree_swap(struct tree_item *root)
 {
 	struct tree *new_tree, *old_tree;
 
-	new_tree = tree_alloc();
+	new_tree = tree_alloc(root);
+	tree_item_free(root);
 	if(NULL == new_tree)
 		return -1;
 
-	new_tree->root = root;
-
 	/* Save old tree */
 	old_tree = tree_get();
 
@@ -394,7 +495,7 @@ int tree_route_get(const str *user)
 		return -1;
 	}
 
-	route = tree_item_get(tree->root, user);
+	route = tree_node_get(tree, user);
 	tree_deref(tree);
 
 	return route;
@@ -411,7 +512,8 @@ void tree_print(FILE *f)
 
 	if(tree) {
 		fprintf(f, " reference count: %d\n", atomic_get(&tree->refcnt));
-		tree_item_print(tree->root, f, 0);
+		fprintf(f, " nodes: %u (%lu bytes)\n", tree->nnodes, tree->size);
+		tree_node_print(tree, 0, f, 0);
 	} else {
 		fprintf(f, " (no tree)\n");
 	}
@@ -35,8 +35,6 @@ struct tree_item *tree_item_alloc(void);
 void tree_item_free(struct tree_item *item);
 int tree_item_add(struct tree_item *root, const char *prefix, const char *route,
 		int route_ix);
-int tree_item_get(const struct tree_item *root, const str *user);
-void tree_item_print(const struct tree_item *item, FILE *f, int level);
 
 
 struct tree;
@@ -139,6 +139,7 @@ int sl_reply_helper(struct sip_msg *msg, int code, char *reason, str *tag)
 	sr_kemi_eng_t *keng = NULL;
 	str evname = str_init("sl:local-response");
 	struct sip_msg pmsg;
+	unsigned int sl_expire;
 
 	if(msg->first_line.u.request.method_value == METHOD_ACK)
 		goto error;
@@ -193,7 +194,11 @@ int sl_reply_helper(struct sip_msg *msg, int code, char *reason, str *tag)
 
 	sl_run_callbacks(SLCB_REPLY_READY, msg, code, reason, &buf, &dst);
 
-	*(sl_timeout) = get_ticks_raw() + SL_RPL_WAIT_TIME;
+	/* update the shared timeout only when it changes, to avoid bouncing
+	 * its cache line between processes under high reply rates */
+	sl_expire = get_ticks_raw() + SL_RPL_WAIT_TIME;
+	if(*(sl_timeout) != sl_expire)
+		*(sl_timeout) = sl_expire;
 
 	/* suppress multihoming support when sending a reply back -- that makes sure
 	 * that replies will come from where requests came in; good for NATs
@@ -217,7 +222,9 @@ int sl_reply_helper(struct sip_msg *msg, int code, char *reason, str *tag)
 
 	mhomed = backup_mhomed;
 
-	keng = sr_kemi_eng_get();
+	/* the reply is parsed back only if something consumes it */
+	if(_sl_evrt_local_response < 0 && _sl_event_callback_lres_sent.len > 0)
+		keng = sr_kemi_eng_get();
 	if(_sl_evrt_local_response >= 0 || keng != NULL
 			|| sr_event_enabled(SREV_SIP_REPLY_OUT)) {
 		if(likely(build_sip_msg_from_buf(&pmsg, buf.s, buf.len, inc_msg_no())
@@ -54,6 +54,7 @@ struct cfg_group_tm default_tm_cfg = {
 		INV_FR_TIME_OUT,	  /* fr_inv_timeout */
 		INV_FR_TIME_OUT_NEXT, /* fr_inv_timeout_next */
 		WT_TIME_OUT,		  /* wait_timeout */
+		0,					  /* wait_timeout_reliable -- 0: use wait_timeout */
 		RETR_T1,			  /* rt_t1_timeout_ms */
 		RETR_T2,			  /* rt_t2_timeout_ms */
 
@@ -134,6 +135,10 @@ cfg_def_t tm_cfg_def[] = {
 		{"wt_timer", CFG_VAR_INT | CFG_ATOMIC, 0, 0, timer_fixup, 0,
 				"time for which a transaction stays in memory to absorb "
 				"delayed messages after it completed"},
+		{"wt_timer_reliable", CFG_VAR_INT | CFG_ATOMIC, 0, 0,
+				timer_fixup_zero_ok, 0,
+				"wait time for transactions with only reliable transport "
+				"hops (in milliseconds, 0 means use wt_timer)"},
 		{"retr_timer1", CFG_VAR_INT | CFG_ATOMIC, 0, 0, timer_fixup_ms, 0,
 				"initial retransmission period (in milliseconds)"},
 		{"retr_timer2", CFG_VAR_INT | CFG_ATOMIC, 0, 0, timer_fixup_ms, 0,
@@ -113,6 +113,7 @@ struct cfg_group_tm
 	unsigned int fr_inv_timeout;
 	unsigned int fr_inv_timeout_next;
 	unsigned int wait_timeout;
+	unsigned int wait_timeout_reliable;
 	unsigned int rt_t1_timeout_ms;
 	unsigned int rt_t2_timeout_ms;
 	unsigned int tm_max_inv_lifetime;
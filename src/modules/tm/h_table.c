@@ -88,7 +88,15 @@ void lock_hash(int i)
 
 	mypid = my_pid();
 	if(likely(atomic_get(&_tm_table->entries[i].locker_pid) != mypid)) {
+#ifdef TM_HASH_STATS
+		if(unlikely(_trylock(&_tm_table->entries[i].mutex) != 0)) {
+			lock(&_tm_table->entries[i].mutex);
+			/* updated while holding the lock */
+			_tm_table->entries[i].lock_waits++;
+		}
+#else
 		lock(&_tm_table->entries[i].mutex);
+#endif
 		atomic_set(&_tm_table->entries[i].locker_pid, mypid);
 	} else {
 		/* locked within the same process that called us*/
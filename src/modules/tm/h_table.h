@@ -32,10 +32,11 @@
 
 #include "t_stats.h"
 
-/* uncomment the next define if you wish to keep hash statistics*/
-/*
+/* hash statistics (chain lengths, lock contention) are kept by default,
+ * define TM_NO_HASH_STATS to disable them */
+#ifndef TM_NO_HASH_STATS
 #define TM_HASH_STATS
-*/
+#endif
 /* use hash stats always in debug mode */
 #ifdef EXTRA_DEBUG
 #ifndef TM_HASH_STATS
@@ -479,6 +480,7 @@ typedef struct entry
 #ifdef TM_HASH_STATS
 	unsigned long acc_entries;
 	unsigned long cur_entries;
+	unsigned long lock_waits; /* lock acquisitions that had to wait */
 #endif
 	char _pad[ENTRY_PAD_BYTES];
 } tm_entry_t;
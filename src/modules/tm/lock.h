@@ -83,6 +83,17 @@ static inline void _lock(ser_lock_t *s)
 }
 
 
+/* try to lock semaphore s, returns 0 on success, !=0 if already locked */
+static inline int _trylock(ser_lock_t *s)
+{
+#ifdef GEN_LOCK_T_PREFERED
+	return lock_try(s);
+#else
+	return lock_set_try(s->semaphore_set, s->semaphore_index);
+#endif
+}
+
+
 #ifdef DBG_LOCK
 static inline void _unlock(
 		ser_lock_t *s, char *file, char *function, unsigned int line)
@@ -243,7 +243,6 @@ char *lw_next_line(char *buf, char *buf_end)
 	return c;
 }
 
-#ifdef USE_DNS_FAILOVER
 /* returns the pointer to the first VIA header */
 char *lw_find_via(char *buf, char *buf_end)
 {
@@ -265,4 +264,3 @@ char *lw_find_via(char *buf, char *buf_end)
 	/* not found */
 	return 0;
 }
-#endif
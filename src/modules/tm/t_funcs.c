@@ -110,10 +110,29 @@ int t_release_transaction(struct cell *trans)
 /* -----------------------HELPER FUNCTIONS----------------------- */
 
 
+/* returns 1 if all the hops of the transaction (the received request and
+ * every forwarded branch) use a reliable transport, 0 otherwise */
+static inline int t_reliable_only(struct cell *t)
+{
+	int i;
+
+	if(!is_local(t)
+			&& (t->uas.response.dst.proto == PROTO_UDP
+					|| t->uas.response.dst.proto == PROTO_NONE))
+		return 0;
+	for(i = 0; i < t->nr_of_outgoings; i++) {
+		if(t->uac[i].request.dst.proto == PROTO_UDP)
+			return 0;
+	}
+	return 1;
+}
+
+
 /*
  */
 void put_on_wait(struct cell *Trans)
 {
+	ticks_t wait;
 
 	LM_DBG("put T [%p] on wait\n", Trans);
 
@@ -134,7 +153,16 @@ void put_on_wait(struct cell *Trans)
 		4.									WAIT timer executed,
 											transaction deleted
 	*/
-	if(timer_add(&Trans->wait_timer, cfg_get(tm, tm_cfg, wait_timeout)) == 0) {
+	/* no retransmissions to absorb over reliable transports (rfc3261
+	 * timers I, J and K are 0), so such transactions can go sooner - not
+	 * for INVITEs without a negative final reply, their wait state still
+	 * relays 2xx replies of other branches and matches the end-to-end
+	 * ACK (rfc6026 timer L is 64*T1 on any transport) */
+	wait = cfg_get(tm, tm_cfg, wait_timeout_reliable);
+	if(wait == 0 || (is_invite(Trans) && Trans->uas.status < 300)
+			|| !t_reliable_only(Trans))
+		wait = cfg_get(tm, tm_cfg, wait_timeout);
+	if(timer_add(&Trans->wait_timer, wait) == 0) {
 		/* success */
 		t_stats_wait();
 	} else {
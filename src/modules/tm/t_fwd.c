@@ -49,11 +49,11 @@
 #include "h_table.h"
 #include "../../core/fix_lumps.h"
 #include "config.h"
+#include "../../core/msg_translator.h"
+#include "lw_parser.h"
 #ifdef USE_DNS_FAILOVER
 #include "../../core/dns_cache.h"
 #include "../../core/cfg_core.h" /* cfg_get(core, core_cfg, use_dns_failover) */
-#include "../../core/msg_translator.h"
-#include "lw_parser.h"
 #endif
 #ifdef USE_DST_BLOCKLIST
 #include "../../core/dst_blocklist.h"
@@ -93,6 +93,12 @@ static int goto_on_branch = 0, branch_route = 0;
 /* E2E_CANCEL_HOP_BY_HOP - cancel hop by hop */
 int tm_e2e_cancel_hop_by_hop = 1;
 
+/* build parallel forking branches from the buffer of the first one */
+int tm_fwd_branch_template = 0;
+/* index of the template branch for the branches added by the current
+ * t_forward_nonack() (-1 - not set yet, -2 - no template usage) */
+static int _tm_fwd_tmpl_branch = -2;
+
 void t_on_branch(unsigned int go_to)
 {
 	struct cell *t = get_t();
@@ -315,6 +321,77 @@ void tm_branch_restore_msg_fields(sip_msg_t *i_req, tm_branch_bak_t *bbak)
  *
  * @return  0 on success, < 0 (ser_errror E***) on failure.
  */
+/* Builds the request for a new branch from the buffer of a previous branch
+ * of the same t_forward_nonack() step, printed with the same lumps and send
+ * socket, by replacing the request URI and the first Via header.
+ * The branch value must be already computed in i_req->add_to_branch_s.
+ */
+static char *print_uac_request_from_tmpl(struct cell *t, struct sip_msg *i_req,
+		int branch, str *uri, unsigned int *len, struct dest_info *dst,
+		struct ua_client *tuac)
+{
+	char *shbuf;
+	char *buf, *buf_end;
+	char *ruri_end;
+	str branch_str;
+	char *via, *old_via_begin, *old_via_end;
+	char *p;
+	unsigned int via_len;
+	ksr_msgbuild_t mbd = {0};
+
+	shbuf = 0;
+	buf = tuac->request.buffer;
+	buf_end = buf + tuac->request.buffer_len;
+	ruri_end = tuac->uri.s + tuac->uri.len;
+	branch_str.s = i_req->add_to_branch_s;
+	branch_str.len = i_req->add_to_branch_len;
+
+	old_via_begin = lw_find_via(buf, buf_end);
+	if(!old_via_begin || old_via_begin < ruri_end) {
+		LM_ERR("beginning of via header not found\n");
+		goto error00;
+	}
+	old_via_end = lw_next_line(old_via_begin, buf_end);
+	if(!old_via_end) {
+		LM_ERR("end of via header not found\n");
+		goto error00;
+	}
+
+	mbd.tvbflags = t->uac[branch].vbflags;
+	via = create_via_hf(&via_len, i_req, dst, &branch_str, &mbd);
+	if(!via) {
+		LM_ERR("via building failed\n");
+		goto error00;
+	}
+
+	*len = tuac->request.buffer_len + uri->len - tuac->uri.len + via_len
+		   - (old_via_end - old_via_begin);
+	shbuf = (char *)shm_malloc(*len);
+	if(!shbuf) {
+		ser_error = E_OUT_OF_MEM;
+		SHM_MEM_ERROR;
+		goto error01;
+	}
+
+	/* request line with the new uri, headers till the first via, new via
+	 * and the rest of the template buffer */
+	p = shbuf;
+	memcpy(p, buf, tuac->uri.s - buf);
+	p += tuac->uri.s - buf;
+	memcpy(p, uri->s, uri->len);
+	p += uri->len;
+	memcpy(p, ruri_end, old_via_begin - ruri_end);
+	p += old_via_begin - ruri_end;
+	memcpy(p, via, via_len);
+	p += via_len;
+	memcpy(p, old_via_end, buf_end - old_via_end);
+
+error01:
+	pkg_free(via);
+error00:
+	return shbuf;
+}
+
 static int prepare_new_uac(struct cell *t, struct sip_msg *i_req, int branch,
 		str *uri, str *path, str *next_hop, struct socket_info *fsocket,
 		snd_flags_t snd_flags, int fproto, int flags, str *instance, str *ruid,
@@ -335,8 +412,11 @@ static int prepare_new_uac(struct cell *t, struct sip_msg *i_req, int branch,
 	sip_msg_t *b_req = NULL;
 	char l_buf[BUF_SIZE];
 	int l_copy;
+	int tmpl;
+	struct ua_client *tuac;
 
 	l_copy = 0;
+	tmpl = 0;
 	shbuf = 0;
 	ret = E_UNSPEC;
 	memset(&bbak, 0, sizeof(tm_branch_bak_t));
@@ -468,6 +548,14 @@ static int prepare_new_uac(struct cell *t, struct sip_msg *i_req, int branch,
 		if(b_req->path_vec.s != 0 && bbak.free_path == 0)
 			bbak.free_path = 1;
 	} else {
+		/* no branch route and no TMCB_REQUEST_FWDED callback => the lumps
+		 * are the same for all the branches of this forwarding step,
+		 * the request can be built from a template branch if there
+		 * is no path */
+		if(_tm_fwd_tmpl_branch > -2 && l_copy == 0
+				&& (path == 0 || path->len == 0)) {
+			tmpl = 1;
+		}
 		/* no branch route and no TMCB_REQUEST_FWDED callback => set
 		 * msg uri and path to the new values (if needed) */
 		if(unlikely((uri->s != b_req->new_uri.s
@@ -553,8 +641,29 @@ static int prepare_new_uac(struct cell *t, struct sip_msg *i_req, int branch,
 		goto error01;
 	}
 	/* ... and build it now */
-	mbd.tvbflags = t->uac[branch].vbflags;
-	shbuf = build_req_buf_from_sip_req(b_req, &len, dst, BUILD_IN_SHM, &mbd);
+	tuac = NULL;
+	if(tmpl && _tm_fwd_tmpl_branch >= 0
+			&& !(dst->proto == PROTO_UDP && cfg_get(core, core_cfg, udp_mtu)
+					&& ((b_req->msg_flags | global_req_flags)
+							& FL_MTU_FB_MASK))) {
+		/* the via header and the lumps depend on the send socket (udp
+		 * requests that may switch protocol on udp_mtu are always built
+		 * in full) */
+		tuac = &t->uac[_tm_fwd_tmpl_branch];
+		if(tuac->request.dst.send_sock != dst->send_sock
+				|| tuac->request.dst.proto != dst->proto
+				|| tuac->vbflags != t->uac[branch].vbflags) {
+			tuac = NULL;
+		}
+	}
+	if(tuac) {
+		shbuf = print_uac_request_from_tmpl(t, b_req, branch, uri, &len, dst,
+				tuac);
+	} else {
+		mbd.tvbflags = t->uac[branch].vbflags;
+		shbuf = build_req_buf_from_sip_req(
+				b_req, &len, dst, BUILD_IN_SHM, &mbd);
+	}
 	if(!shbuf || len <= 0) {
 		LM_ERR("could not build request\n");
 		if(shbuf) {
@@ -660,11 +769,21 @@ static int prepare_new_uac(struct cell *t, struct sip_msg *i_req, int branch,
 				b_req->location_ua.len);
 	}
 
-	len = count_applied_lumps(b_req->add_rm, HDR_RECORDROUTE_T);
-	if(len == 1)
-		t->uac[branch].flags = TM_UAC_FLAG_RR;
-	else if(len == 2)
-		t->uac[branch].flags = TM_UAC_FLAG_RR | TM_UAC_FLAG_R2;
+	if(tuac) {
+		if(tuac->flags & (TM_UAC_FLAG_RR | TM_UAC_FLAG_R2))
+			t->uac[branch].flags =
+					tuac->flags & (TM_UAC_FLAG_RR | TM_UAC_FLAG_R2);
+	} else {
+		len = count_applied_lumps(b_req->add_rm, HDR_RECORDROUTE_T);
+		if(len == 1)
+			t->uac[branch].flags = TM_UAC_FLAG_RR;
+		else if(len == 2)
+			t->uac[branch].flags = TM_UAC_FLAG_RR | TM_UAC_FLAG_R2;
+		if(tmpl && _tm_fwd_tmpl_branch == -1) {
+			/* first branch printed in full - template for the next ones */
+			_tm_fwd_tmpl_branch = branch;
+		}
+	}
 
 	ret = 0;
 
@@ -1752,6 +1871,11 @@ int t_forward_nonack(
 		}
 	}
 
+	/* branches without branch route can be built from the first one */
+	if(tm_fwd_branch_template) {
+		_tm_fwd_tmpl_branch = -1;
+	}
+
 	/* if ruri is not already consumed (by another invocation), use current
 	 * uri too. Else add only additional branches (which may be continuously
 	 * refilled).
@@ -1808,6 +1932,7 @@ int t_forward_nonack(
 	}
 	/* consume processed branches */
 	clear_branches();
+	_tm_fwd_tmpl_branch = -2;
 
 	setbflagsval(0, backup_bflags);
 
@@ -1872,6 +1997,7 @@ canceled:
 	LM_DBG("no forwarding on a canceled transaction\n");
 	/* reset processed branches */
 	clear_branches();
+	_tm_fwd_tmpl_branch = -2;
 	/* restore backup flags from initial env */
 	setbflagsval(0, backup_bflags);
 	/* update message flags, if changed in branch route */
@@ -29,6 +29,9 @@
 /* E2E_CANCEL_HOP_BY_HOP - cancel hop by hop */
 extern int tm_e2e_cancel_hop_by_hop;
 
+/* build parallel forking branches from the buffer of the first one */
+extern int tm_fwd_branch_template;
+
 enum unmatched_cancel_t
 {
 	UM_CANCEL_STATEFULL = 0,
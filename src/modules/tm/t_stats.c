@@ -23,6 +23,7 @@
 
 
 #include <stdio.h>
+#include <string.h>
 #include "t_stats.h"
 #include "../../core/mem/shm_mem.h"
 #include "../../core/dprint.h"
@@ -30,6 +31,9 @@
 #include "../../core/pt.h"
 #include "h_table.h"
 
+/* number of slots in the hash chain length histogram */
+#define TM_HASH_HIST_SLOTS 8
+
 union t_stats *tm_stats = 0;
 
 int init_tm_stats(void)
@@ -176,7 +180,12 @@ void tm_rpc_hash_stats(rpc_t *rpc, void *c)
 	double acc_average, acc_dev, acc_d;
 	double crt_average, crt_dev, crt_d;
 	unsigned long acc, crt;
+	unsigned long waits, waits_sum, waits_max;
+	unsigned long crt_hist[TM_HASH_HIST_SLOTS];
+	void *hst;
+	char hname[24];
 	int r;
+	int h;
 
 	acc_count = 0;
 	acc_min = (unsigned long)(-1);
@@ -190,9 +199,21 @@ void tm_rpc_hash_stats(rpc_t *rpc, void *c)
 	crt_zeroes = 0;
 	crt_dev_no = 0;
 	crt_dev = 0;
+	waits_sum = 0;
+	waits_max = 0;
+	memset(crt_hist, 0, sizeof(crt_hist));
 	for(r = 0; r < TABLE_ENTRIES; r++) {
 		acc = _tm_table->entries[r].acc_entries;
 		crt = _tm_table->entries[r].cur_entries;
+		waits = _tm_table->entries[r].lock_waits;
+
+		waits_sum += waits;
+		if(waits > waits_max)
+			waits_max = waits;
+		/* chain length histogram: 0, 1, 2-3, 4-7, ... */
+		for(h = 0; h < TM_HASH_HIST_SLOTS - 1 && (crt >> h) != 0; h++)
+			;
+		crt_hist[h]++;
 
 		acc_count += acc;
 		if(acc < acc_min)
@@ -254,10 +275,24 @@ void tm_rpc_hash_stats(rpc_t *rpc, void *c)
 	rpc->struct_add(st, "d", "acc_no_zero_cells", (unsigned)acc_zeroes);
 	rpc->struct_add(st, "d", "acc_no_deviating_cells", acc_dev_no);
 	rpc->struct_add(st, "f", "acc_deviation_sq_sum", acc_dev);
+	rpc->struct_add(st, "jj", "lock_waits", (unsigned long)waits_sum,
+			"lock_waits_max", (unsigned long)waits_max);
+	if(rpc->struct_add(st, "{", "crt_chain_hist", &hst) < 0)
+		return;
+	for(h = 0; h < TM_HASH_HIST_SLOTS; h++) {
+		if(h < 2)
+			snprintf(hname, sizeof(hname), "%d", h);
+		else if(h < TM_HASH_HIST_SLOTS - 1)
+			snprintf(hname, sizeof(hname), "%d-%d", 1 << (h - 1),
+					(1 << h) - 1);
+		else
+			snprintf(hname, sizeof(hname), "%d+", 1 << (h - 1));
+		rpc->struct_add(hst, "d", hname, (unsigned)crt_hist[h]);
+	}
 #else  /* TM_HASH_STATS */
 	rpc->fault(c, 500,
-			"Hash statistics not supported (try"
-			"recompiling with -DTM_HASH_STATS)");
+			"Hash statistics not supported (tm was"
+			" compiled with -DTM_NO_HASH_STATS)");
 #endif /* TM_HASH_STATS */
 }
 
@@ -152,6 +152,12 @@ int tm_init_timers(void)
 	default_tm_cfg.fr_timeout = MS_TO_TICKS(default_tm_cfg.fr_timeout);
 	default_tm_cfg.fr_inv_timeout = MS_TO_TICKS(default_tm_cfg.fr_inv_timeout);
 	default_tm_cfg.wait_timeout = MS_TO_TICKS(default_tm_cfg.wait_timeout);
+	if(default_tm_cfg.wait_timeout_reliable) {
+		default_tm_cfg.wait_timeout_reliable =
+				MS_TO_TICKS(default_tm_cfg.wait_timeout_reliable);
+		if(default_tm_cfg.wait_timeout_reliable == 0)
+			default_tm_cfg.wait_timeout_reliable = 1;
+	}
 	default_tm_cfg.tm_max_inv_lifetime =
 			MS_TO_TICKS(default_tm_cfg.tm_max_inv_lifetime);
 	default_tm_cfg.tm_max_noninv_lifetime =
@@ -249,6 +255,25 @@ error:
 }
 
 
+/** fixup function for timer values where 0 means disabled.
+ * (called by the configuration framework)
+ * Like timer_fixup(), but a 0 value is kept as it is
+ */
+int timer_fixup_zero_ok(void *handle, str *gname, str *name, void **val)
+{
+	ticks_t t;
+
+	if((long)(*val) == 0)
+		return 0;
+	t = MS_TO_TICKS((unsigned int)(long)(*val));
+	/* fix non-0 values to at least 1 tick */
+	if(t == 0)
+		t = 1;
+	*val = (void *)(long)t;
+	return 0;
+}
+
+
 /** fixup function for timer values that are kept in ms.
  * (called by the configuration framework)
  * It checks if the value fits in the tm structures
@@ -139,6 +139,7 @@ extern int tm_init_timers(void);
  * \return 0 on success, -1 on error
  */
 int timer_fixup(void *handle, str *gname, str *name, void **val);
+int timer_fixup_zero_ok(void *handle, str *gname, str *name, void **val);
 int timer_fixup_ms(void *handle, str *gname, str *name, void **val);
 
 ticks_t wait_handler(ticks_t t, struct timer_ln *tl, void *data);
@@ -485,6 +485,7 @@ static param_export_t params[] = {
 	{"fr_timer", PARAM_INT, &default_tm_cfg.fr_timeout},
 	{"fr_inv_timer", PARAM_INT, &default_tm_cfg.fr_inv_timeout},
 	{"wt_timer", PARAM_INT, &default_tm_cfg.wait_timeout},
+	{"wt_timer_reliable", PARAM_INT, &default_tm_cfg.wait_timeout_reliable},
 	{"retr_timer1", PARAM_INT, &default_tm_cfg.rt_t1_timeout_ms},
 	{"retr_timer2", PARAM_INT, &default_tm_cfg.rt_t2_timeout_ms},
 	{"max_inv_lifetime", PARAM_INT, &default_tm_cfg.tm_max_inv_lifetime},
@@ -533,6 +534,7 @@ static param_export_t params[] = {
 	{"local_cancel_reason", PARAM_INT, &default_tm_cfg.local_cancel_reason},
 	{"e2e_cancel_reason", PARAM_INT, &default_tm_cfg.e2e_cancel_reason},
 	{"e2e_cancel_hop_by_hop", PARAM_INT, &tm_e2e_cancel_hop_by_hop},
+	{"fwd_branch_template", PARAM_INT, &tm_fwd_branch_template},
 	{"headers_mode", PARAM_INT, &tm_headers_mode},
 	{"xavp_contact", PARAM_STR, &ulattrs_xavp_name},
 	{"event_callback", PARAM_STR, &tm_event_callback},
@@ -2915,8 +2917,9 @@ static const char *tm_rpc_stats_doc[2] = {
 };
 
 static const char *tm_rpc_hash_stats_doc[2] = {
-	"Prints hash table statistics (can be used only if tm is compiled"
-	" with -DTM_HASH_STATS).",
+	"Prints hash table statistics: chain lengths histogram and"
+	" lock contention (not available if tm is compiled"
+	" with -DTM_NO_HASH_STATS).",
 	0
 };
 
@@ -570,8 +570,10 @@ static inline int get_all_mem_ucontacts(void *buf, int len, unsigned int flags,
 							if(c->last_keepalive + ul_keepalive_timeout
 									< tnow) {
 								/* set contact as expired in 10s */
-								if(c->expires > tnow + 10)
+								if(c->expires > tnow + 10) {
 									c->expires = tnow + 10;
+									ul_slot_timer_reset(r->slot);
+								}
 								continue;
 							}
 						}
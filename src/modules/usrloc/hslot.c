@@ -42,6 +42,7 @@ int init_slot(struct udomain *_d, hslot_t *_s, int n)
 	_s->first = 0;
 	_s->last = 0;
 	_s->d = _d;
+	_s->next_timer = 0;
 	if(rec_lock_init(&_s->rlock) == NULL) {
 		LM_ERR("failed to initialize the slock (%d)\n", n);
 		return -1;
@@ -88,6 +89,7 @@ void slot_add(hslot_t *_s, struct urecord *_r)
 	}
 	_s->n++;
 	_r->slot = _s;
+	ul_slot_timer_reset(_s);
 }
 
 
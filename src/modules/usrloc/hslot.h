@@ -29,6 +29,9 @@
 #ifndef HSLOT_H
 #define HSLOT_H
 
+#include <limits.h>
+#include <time.h>
+
 #include "../../core/locking.h"
 
 #include "udomain.h"
@@ -46,8 +49,21 @@ typedef struct hslot
 	struct urecord *last;  /*!< Last element in the list */
 	struct udomain *d;	   /*!< Domain we belong to */
 	rec_lock_t rlock;	   /*!< Recursive lock for hash entry */
+	time_t next_timer; /*!< Earliest time the slot needs timer processing */
 } hslot_t;
 
+/*! \brief Value of next_timer for a slot without contacts to expire */
+#define UL_SLOT_TIMER_NEVER ((time_t)LONG_MAX)
+
+/*! \brief
+ * Mark the slot to be processed by the next timer run, to be used
+ * whenever a contact is added or its expires or db state are changed
+ */
+#define ul_slot_timer_reset(_s) \
+	do {                        \
+		(_s)->next_timer = 0;   \
+	} while(0)
+
 /*! \brief
  * Initialize slot structure
  */
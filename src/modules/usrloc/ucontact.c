@@ -41,6 +41,7 @@
 #include "usrloc.h"
 #include "urecord.h"
 #include "ucontact.h"
+#include "hslot.h"
 
 extern int ul_db_insert_null;
 
@@ -1754,6 +1755,8 @@ int update_ucontact(struct urecord *_r, ucontact_t *_c, ucontact_info_t *_ci)
 	if(_r) {
 		if(ul_db_mode != DB_ONLY) {
 			update_contact_pos(_r, _c);
+			if(_r->slot)
+				ul_slot_timer_reset(_r->slot);
 		} else {
 			/* urecord was static restore copy */
 			memcpy(_r, &_ur, sizeof(struct urecord));
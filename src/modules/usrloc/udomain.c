@@ -47,6 +47,7 @@
 
 extern int ul_rm_expired_delay;
 extern int ul_db_clean_tcp;
+extern int ul_ka_mode;
 
 enum col_index
 {
@@ -1258,8 +1259,45 @@ void mem_delete_urecord(udomain_t *_d, struct urecord *_r)
 }
 
 
+/*!
+ * \brief Compute the earliest time the slot needs timer processing
+ *
+ * The slot has to be processed when a contact expires or when a contact
+ * is not yet synchronized with database in write back modes.
+ * \param _s hash slot, must be locked
+ * \return time of next processing, UL_SLOT_TIMER_NEVER if none
+ */
+static time_t mem_next_timer_slot(hslot_t *_s)
+{
+	struct urecord *r;
+	ucontact_t *c;
+	time_t tnext = UL_SLOT_TIMER_NEVER;
+
+	for(r = _s->first; r != NULL; r = r->next) {
+		if(r->contacts == NULL) {
+			return 0;
+		}
+		for(c = r->contacts; c != NULL; c = c->next) {
+			if((ul_db_mode == WRITE_BACK || ul_db_mode == WRITE_THROUGH)
+					&& c->state != CS_SYNC) {
+				return 0;
+			}
+			if(c->expires != 0 && c->expires < tnext) {
+				tnext = c->expires;
+			}
+		}
+	}
+	return tnext;
+}
+
+
 /*!
  * \brief Run timer handler for given domain, delete urecords
+ *
+ * Slots are skipped without walking their records when the last run
+ * found no contact to expire before the current time. The skip is not
+ * done when every contact has to be checked on each run, for keepalive
+ * or detection of lost tcp connections.
  * \param _d domain
  * \param istart start of run
  * \param istep loop steps
@@ -1268,8 +1306,15 @@ void mem_timer_udomain(udomain_t *_d, int istart, int istep)
 {
 	struct urecord *ptr, *t;
 	int i;
+	int skip;
+
+	skip = (ul_ka_mode == ULKA_NONE && ul_handle_lost_tcp == 0
+			&& destroy_modules_phase() == 0);
 
 	for(i = istart; i < _d->size; i += istep) {
+		if(skip && _d->table[i].next_timer > ul_act_time) {
+			continue;
+		}
 		if(likely(destroy_modules_phase() == 0))
 			lock_ulslot(_d, i);
 
@@ -1287,6 +1332,9 @@ void mem_timer_udomain(udomain_t *_d, int istart, int istep)
 				ptr = ptr->next;
 			}
 		}
+		if(skip) {
+			_d->table[i].next_timer = mem_next_timer_slot(&_d->table[i]);
+		}
 		if(likely(destroy_modules_phase() == 0))
 			unlock_ulslot(_d, i);
 	}
@@ -41,6 +41,7 @@
 #include "usrloc.h"
 #include "utime.h"
 #include "ul_callback.h"
+#include "hslot.h"
 
 /*! contact matching mode */
 int ul_matching_mode = CONTACT_ONLY;
@@ -152,6 +153,8 @@ ucontact_t *mem_insert_ucontact(urecord_t *_r, str *_c, ucontact_info_t *_ci)
 		return 0;
 	}
 	if_update_stat(_r->slot, _r->slot->d->contacts, 1);
+	if(_r->slot)
+		ul_slot_timer_reset(_r->slot);
 
 	ptr = _r->contacts;
 
@@ -661,6 +664,9 @@ int delete_ucontact(urecord_t *_r, struct ucontact *_c)
 		}
 
 		mem_delete_ucontact(_r, _c);
+	} else if(_r->slot) {
+		/* contact kept for the timer to delete it from db */
+		ul_slot_timer_reset(_r->slot);
 	}
 
 	return ret;